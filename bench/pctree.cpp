@@ -0,0 +1,554 @@
+/** \file
+ * \brief Benchmarks for PCTree::makeConsecutive().
+ *
+ * Use --benchmark_format=json or --benchmark_out=<file> to obtain machine-readable results,
+ * e.g. for tracking performance regressions across commits.
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#include <pctree/PCNode.h>
+#include <pctree/PCTree.h>
+#include <pctree/PCTreeBatchSolver.h>
+#include <pctree/util/DisjointSets.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#	include <sys/resource.h>
+#endif
+
+using namespace pc_tree;
+
+using Restriction = std::vector<int>;
+
+/**
+ * Resets the peak resident set size of this process, so that peakRSS() reports the peak of a single benchmark.
+ * Only supported on Linux, elsewhere the peak of the whole process is reported.
+ */
+static void resetPeakRSS() {
+#ifdef __linux__
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+#endif
+}
+
+//! Peak resident set size of this process in KiB, or 0 if unsupported on this platform.
+static double peakRSS() {
+#ifdef __linux__
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.rfind("VmHWM:", 0) == 0) {
+			return std::stod(line.substr(6));
+		}
+	}
+	return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+	rusage usage {};
+	getrusage(RUSAGE_SELF, &usage);
+#	ifdef __APPLE__
+	return usage.ru_maxrss / 1024.0;
+#	else
+	return usage.ru_maxrss;
+#	endif
+#else
+	return 0;
+#endif
+}
+
+//! \p count random cyclic intervals of length \p size in a random hidden order of \p leafCount leaves.
+static std::vector<Restriction> randomIntervals(int leafCount, int size, int count, std::mt19937& rng) {
+	std::vector<int> hidden(leafCount);
+	std::iota(hidden.begin(), hidden.end(), 0);
+	std::shuffle(hidden.begin(), hidden.end(), rng);
+	std::uniform_int_distribution<int> start(0, leafCount - 1);
+	std::vector<Restriction> restrictions(count);
+	for (Restriction& r : restrictions) {
+		int s = start(rng);
+		r.reserve(size);
+		for (int i = 0; i < size; ++i) {
+			r.push_back(hidden[(s + i) % leafCount]);
+		}
+	}
+	return restrictions;
+}
+
+//! The \p leafCount cyclic windows of length \p size of the identity order, i.e. a banded C1P matrix.
+static std::vector<Restriction> slidingWindows(int leafCount, int size) {
+	std::vector<Restriction> restrictions(leafCount);
+	for (int s = 0; s < leafCount; ++s) {
+		restrictions[s].reserve(size);
+		for (int i = 0; i < size; ++i) {
+			restrictions[s].push_back((s + i) % leafCount);
+		}
+	}
+	return restrictions;
+}
+
+//! \p count uniformly random leaf subsets of size \p size, which are usually not consecutive.
+static std::vector<Restriction> randomSets(int leafCount, int size, int count, std::mt19937& rng) {
+	std::vector<int> leaves(leafCount);
+	std::iota(leaves.begin(), leaves.end(), 0);
+	std::vector<Restriction> restrictions(count);
+	for (Restriction& r : restrictions) {
+		std::shuffle(leaves.begin(), leaves.end(), rng);
+		r.assign(leaves.begin(), leaves.begin() + size);
+	}
+	return restrictions;
+}
+
+static std::vector<std::vector<PCNode*>> toLeaves(const std::vector<Restriction>& restrictions,
+		const std::vector<PCNode*>& leaves) {
+	std::vector<std::vector<PCNode*>> result(restrictions.size());
+	for (size_t i = 0; i < restrictions.size(); ++i) {
+		for (int idx : restrictions[i]) {
+			result[i].push_back(leaves[idx]);
+		}
+	}
+	return result;
+}
+
+static void setCounters(benchmark::State& state, size_t ops) {
+	state.SetItemsProcessed(ops);
+	state.counters["time_per_op"] =
+			benchmark::Counter(ops, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+	state.counters["peak_rss_kib"] = peakRSS();
+}
+
+/**
+ * Applies all \p restrictions to a fresh tree with \p leafCount leaves in every iteration.
+ * Only the calls to PCTree::makeConsecutive() are timed.
+ */
+static void applyAll(benchmark::State& state, int leafCount,
+		const std::vector<Restriction>& restrictions) {
+	resetPeakRSS();
+	size_t ops = 0, failed = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto forest = std::make_unique<PCTreeForest>();
+		std::vector<PCNode*> leaves;
+		auto tree = std::make_unique<PCTree>(leafCount, &leaves, forest.get());
+		auto leafRestrictions = toLeaves(restrictions, leaves);
+		state.ResumeTiming();
+
+		for (auto& r : leafRestrictions) {
+			bool res = tree->makeConsecutive(r.begin(), r.end());
+			benchmark::DoNotOptimize(res);
+			failed += !res;
+		}
+		ops += leafRestrictions.size();
+
+		state.PauseTiming();
+		tree.reset();
+		forest.reset();
+		state.ResumeTiming();
+	}
+	setCounters(state, ops);
+	state.counters["failed"] = benchmark::Counter(failed, benchmark::Counter::kAvgIterations);
+}
+
+//! Satisfiable random C1P instance: n random intervals of length k.
+static void BM_RandomIntervals(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	std::mt19937 rng(42);
+	applyAll(state, n, randomIntervals(n, k, n, rng));
+}
+
+//! Satisfiable structured C1P instance: all n cyclic windows of length k.
+static void BM_SlidingWindows(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	applyAll(state, n, slidingWindows(n, k));
+}
+
+//! Random, mostly unsatisfiable instance: n random subsets of size k, of which all but the first few fail.
+static void BM_RandomSets(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	std::mt19937 rng(42);
+	applyAll(state, n, randomSets(n, k, n, rng));
+}
+
+/**
+ * Failing restrictions only: the tree is first constrained by n/2 random intervals of length k,
+ * then random subsets of size k that cannot be made consecutive are tried repeatedly.
+ * As failing updates leave the tree unchanged, no rebuilding is needed between iterations.
+ */
+static void BM_Failing(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	std::mt19937 rng(42);
+	resetPeakRSS();
+	PCTreeForest forest;
+	std::vector<PCNode*> leaves;
+	PCTree tree(n, &leaves, &forest);
+	for (auto& r : toLeaves(randomIntervals(n, k, n / 2, rng), leaves)) {
+		tree.makeConsecutive(r.begin(), r.end());
+	}
+	std::vector<std::vector<PCNode*>> failing;
+	for (auto& r : toLeaves(randomSets(n, k, 256, rng), leaves)) {
+		// restrictions that succeed only further constrain the tree, so earlier failures stay failures
+		if (!tree.makeConsecutive(r.begin(), r.end())) {
+			failing.push_back(std::move(r));
+		}
+	}
+	if (failing.empty()) {
+		state.SkipWithError("no failing restrictions found");
+		return;
+	}
+
+	size_t ops = 0;
+	for (auto _ : state) {
+		auto& r = failing[ops++ % failing.size()];
+		bool res = tree.makeConsecutive(r.begin(), r.end());
+		benchmark::DoNotOptimize(res);
+	}
+	setCounters(state, ops);
+}
+
+/**
+ * Read-only walks through a tree with n leaves constrained by n/2 random intervals of length k,
+ * each iteration computing the current leaf order and the number of possible orders.
+ */
+static void BM_Walk(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	std::mt19937 rng(42);
+	PCTreeForest forest;
+	std::vector<PCNode*> leaves;
+	PCTree tree(n, &leaves, &forest);
+	for (auto& r : toLeaves(randomIntervals(n, k, n / 2, rng), leaves)) {
+		tree.makeConsecutive(r.begin(), r.end());
+	}
+	resetPeakRSS();
+	std::vector<PCNode*> order;
+	order.reserve(n);
+	size_t ops = 0;
+	for (auto _ : state) {
+		order.clear();
+		tree.currentLeafOrder(order);
+		benchmark::DoNotOptimize(order.data());
+		benchmark::DoNotOptimize(tree.possibleOrders<double>());
+		ops++;
+	}
+	setCounters(state, ops);
+}
+
+/**
+ * Applies n/4 random intervals of length k to a fresh tree with n leaves in every iteration and
+ * queries the position of the first leaf of each restriction in the leaf order afterwards, either
+ * with PCTree::getLeafPosition() if \p cached, whose order is updated by the restrictions, or by
+ * recomputing the order with PCTree::currentLeafOrder().
+ */
+template<bool cached>
+static void BM_LeafOrder(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	std::mt19937 rng(42);
+	auto restrictions = randomIntervals(n, k, n / 4, rng);
+	resetPeakRSS();
+	std::vector<PCNode*> order;
+	order.reserve(n);
+	size_t ops = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto forest = std::make_unique<PCTreeForest>();
+		std::vector<PCNode*> leaves;
+		auto tree = std::make_unique<PCTree>(n, &leaves, forest.get());
+		auto leafRestrictions = toLeaves(restrictions, leaves);
+		if constexpr (cached) {
+			tree->getLeafPosition(leaves.front());
+		}
+		state.ResumeTiming();
+
+		for (auto& r : leafRestrictions) {
+			tree->makeConsecutive(r.begin(), r.end());
+			if constexpr (cached) {
+				benchmark::DoNotOptimize(tree->getLeafPosition(r.front()));
+			} else {
+				order.clear();
+				tree->currentLeafOrder(order);
+				benchmark::DoNotOptimize(std::find(order.begin(), order.end(), r.front()));
+			}
+		}
+		ops += leafRestrictions.size();
+
+		state.PauseTiming();
+		tree.reset();
+		forest.reset();
+		state.ResumeTiming();
+	}
+	setCounters(state, ops);
+}
+
+#define PCTREE_BENCH_STR(x) #x
+#define PCTREE_BENCH_XSTR(x) PCTREE_BENCH_STR(x)
+
+/**
+ * The first call to PCNode::getParent() for every node of a tree with n leaves after applying
+ * n random intervals of length k, which follows the union-find paths built up by the C-node merges.
+ * Uses the union-find policy the library was configured with, see PCTreeUnionFind.
+ */
+static void BM_GetParent(benchmark::State& state) {
+	int n = state.range(0), k = state.range(1);
+	std::mt19937 rng(42);
+	auto restrictions = randomIntervals(n, k, n, rng);
+	resetPeakRSS();
+	size_t ops = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		PCTreeForest forest;
+		std::vector<PCNode*> leaves;
+		PCTree tree(n, &leaves, &forest);
+		for (auto& r : toLeaves(restrictions, leaves)) {
+			tree.makeConsecutive(r.begin(), r.end());
+		}
+		std::vector<PCNode*> nodes(tree.allNodes().begin(), tree.allNodes().end());
+		state.ResumeTiming();
+
+		for (PCNode* node : nodes) {
+			benchmark::DoNotOptimize(node->getParent());
+		}
+		ops += nodes.size();
+	}
+	setCounters(state, ops);
+	state.SetLabel(PCTREE_BENCH_XSTR(PCTREE_UNION_FIND_LINK) "/" PCTREE_BENCH_XSTR(
+			PCTREE_UNION_FIND_COMPRESSION)
+#ifdef PCTREE_UNION_FIND_64BIT
+					"/64bit"
+#endif
+	);
+}
+
+/**
+ * A sequence of union-find operations following the way PCTreeForest uses its union-find structure:
+ * every C-node has a set that it keeps as representative when other C-nodes are merged into it,
+ * while children only store the ID of their parent's set as of the time they were attached and
+ * update it with the result of a find when their parent is queried.
+ */
+struct UnionFindTrace {
+	enum class Op { MakeCNode, Merge, Attach, GetParent };
+
+	struct Step {
+		Op op;
+		int a, b;
+	};
+
+	std::vector<Step> steps;
+	int cNodes = 0;
+	int children = 0;
+	size_t getParents = 0;
+};
+
+/**
+ * Models n updates on a tree with n children, each creating a new central C-node, moving a few
+ * children to it and merging a terminal path of random length into it, before the parents of some
+ * children of the merged nodes are queried.
+ */
+static UnionFindTrace cNodeMergeTrace(int n, std::mt19937& rng) {
+	using Op = UnionFindTrace::Op;
+	UnionFindTrace trace;
+	trace.children = n;
+	std::vector<int> alive;
+	std::vector<std::vector<int>> children;
+	auto makeCNode = [&]() {
+		int c = trace.cNodes++;
+		trace.steps.push_back({Op::MakeCNode, c, 0});
+		alive.push_back(c);
+		children.emplace_back();
+		return c;
+	};
+	for (int x = 0; x < n; ++x) {
+		if (x % 4 == 0) {
+			makeCNode();
+		}
+		trace.steps.push_back({Op::Attach, x, alive.back()});
+		children[alive.back()].push_back(x);
+	}
+
+	std::geometric_distribution<int> pathLength(0.5);
+	std::uniform_int_distribution<int> anyChild(0, n - 1);
+	for (int round = 0; round < n; ++round) {
+		int central = makeCNode();
+		for (int i = 0; i < 2; ++i) {
+			int x = anyChild(rng);
+			trace.steps.push_back({Op::Attach, x, central});
+			children[central].push_back(x);
+		}
+		int length = std::min<int>(1 + pathLength(rng), alive.size() - 1);
+		for (int i = 0; i < length; ++i) {
+			// central is always the last alive C-node
+			std::uniform_int_distribution<size_t> anyAlive(0, alive.size() - 2);
+			size_t pos = anyAlive(rng);
+			int merged = alive[pos];
+			alive[pos] = alive[alive.size() - 2];
+			alive[alive.size() - 2] = central;
+			alive.pop_back();
+			trace.steps.push_back({Op::Merge, merged, central});
+
+			// only the few children next to the terminal path are looked at by an update
+			std::vector<int>& mergedChildren = children[merged];
+			for (int j = 0; j < 4 && !mergedChildren.empty(); ++j) {
+				int x = mergedChildren[rng() % mergedChildren.size()];
+				trace.steps.push_back({Op::GetParent, x, 0});
+				trace.getParents++;
+			}
+			std::vector<int>& centralChildren = children[central];
+			if (centralChildren.size() < mergedChildren.size()) {
+				centralChildren.swap(mergedChildren);
+			}
+			centralChildren.insert(centralChildren.end(), mergedChildren.begin(),
+					mergedChildren.end());
+			std::vector<int>().swap(mergedChildren);
+		}
+	}
+	return trace;
+}
+
+/**
+ * Replays cNodeMergeTrace() with n children on a DisjointSets instance with the given policy,
+ * counting the operations per PCNode::getParent() call.
+ */
+template<LinkOptions link, CompressionOptions compression, typename Index>
+static void BM_UnionFind(benchmark::State& state) {
+	using Op = UnionFindTrace::Op;
+	int n = state.range(0);
+	std::mt19937 rng(42);
+	UnionFindTrace trace = cNodeMergeTrace(n, rng);
+	std::vector<Index> cNodeSet(trace.cNodes);
+	std::vector<Index> parentSet(trace.children);
+	resetPeakRSS();
+	size_t ops = 0;
+	for (auto _ : state) {
+		DisjointSets<link, compression, InterleavingOptions::Disabled, Index> sets(1 << 8);
+		for (const UnionFindTrace::Step& step : trace.steps) {
+			switch (step.op) {
+			case Op::MakeCNode:
+				cNodeSet[step.a] = sets.makeSet();
+				break;
+			case Op::Merge:
+				cNodeSet[step.b] = sets.link(cNodeSet[step.a], cNodeSet[step.b]);
+				break;
+			case Op::Attach:
+				parentSet[step.a] = cNodeSet[step.b];
+				break;
+			case Op::GetParent:
+				parentSet[step.a] = sets.find(parentSet[step.a]);
+				break;
+			}
+		}
+		benchmark::DoNotOptimize(parentSet.data());
+		ops += trace.getParents;
+	}
+	setCounters(state, ops);
+}
+
+/**
+ * Many small satisfiable instances with n leaves and n random intervals of length k each,
+ * solved by a PCTreeBatchSolver with the given number of threads.
+ */
+static void BM_Batch(benchmark::State& state) {
+	int threads = state.range(0), n = state.range(1), k = state.range(2);
+	std::mt19937 rng(42);
+	std::vector<C1PInstance> instances(10000);
+	for (C1PInstance& instance : instances) {
+		instance.leafCount = n;
+		for (const Restriction& r : randomIntervals(n, k, n, rng)) {
+			instance.addRestriction(r);
+		}
+	}
+	PCTreeBatchSolver solver(threads);
+	resetPeakRSS();
+	size_t ops = 0;
+	for (auto _ : state) {
+		std::vector<C1PResult> results = solver.solve(instances);
+		benchmark::DoNotOptimize(results.data());
+		ops += instances.size();
+	}
+	setCounters(state, ops);
+}
+
+static void sizes(benchmark::internal::Benchmark* b) {
+	b->ArgNames({"n", "k"});
+	for (int n : {64, 1024, 16384}) {
+		for (int k : {4, 32}) {
+			if (k < n / 2) {
+				b->Args({n, k});
+			}
+		}
+		if (n <= 1024) {
+			// quadratic total input size, so only for smaller trees
+			b->Args({n, n / 2});
+		}
+	}
+}
+
+BENCHMARK(BM_RandomIntervals)->Apply(sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SlidingWindows)->Apply(sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RandomSets)->Apply(sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Failing)->Apply(sizes);
+BENCHMARK(BM_Walk)->Apply(sizes);
+BENCHMARK(BM_GetParent)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_LeafOrder, true)
+		->ArgNames({"n", "k"})
+		->ArgsProduct({{1024, 16384}, {4}})
+		->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LeafOrder, false)
+		->ArgNames({"n", "k"})
+		->ArgsProduct({{1024, 16384}, {4}})
+		->Unit(benchmark::kMillisecond);
+
+#define BENCHMARK_UNION_FIND(link, compression, index)                                  \
+	BENCHMARK_TEMPLATE(BM_UnionFind, LinkOptions::link, CompressionOptions::compression, index) \
+			->ArgName("n")                                                               \
+			->Arg(1 << 10)                                                               \
+			->Arg(1 << 14)
+#define BENCHMARK_UNION_FIND_LINK(link)                       \
+	BENCHMARK_UNION_FIND(link, PathCompression, int);         \
+	BENCHMARK_UNION_FIND(link, PathSplitting, int);           \
+	BENCHMARK_UNION_FIND(link, PathHalving, int);             \
+	BENCHMARK_UNION_FIND(link, Type1Reversal, int);           \
+	BENCHMARK_UNION_FIND(link, Disabled, int)
+
+BENCHMARK_UNION_FIND_LINK(Naive);
+BENCHMARK_UNION_FIND_LINK(Index);
+BENCHMARK_UNION_FIND_LINK(Size);
+BENCHMARK_UNION_FIND(Index, PathSplitting, int64_t);
+
+BENCHMARK(BM_Batch)
+		->ArgNames({"threads", "n", "k"})
+		->ArgsProduct({{1, 2, 4, 8}, {16}, {4}})
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+
+BENCHMARK_MAIN();
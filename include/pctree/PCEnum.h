@@ -55,7 +55,7 @@ OGDF_DECL_REG_ARRAY(PCTreeNodeArray)
 #undef PCTREE_DECL_REG_ARRAY_TYPE
 
 template<bool SupportFastSizeQuery = true>
-using PCTreeNodeSet = pc_tree::RegisteredSet<PCTreeRegistry, SupportFastSizeQuery>;
+using PCTreeNodeSet = pc_tree::DenseRegisteredSet<PCTreeRegistry, SupportFastSizeQuery>;
 
 OGDF_EXPORT std::ostream& operator<<(std::ostream&, pc_tree::NodeLabel);
 
@@ -39,7 +39,7 @@
 #include <list>
 #include <vector>
 
-#ifdef OGDF_DEBUG
+#ifdef OGDF_HEAVY_DEBUG
 #	include <set>
 #endif
 
@@ -67,52 +67,10 @@ class OGDF_EXPORT PCNode : public IntrusiveList<PCNode>::node {
 	friend struct PCNodeNeighborsIterable;
 
 public:
-	/**
-	 * Temporary information used during each step of the PCTree::makeConsecutive() update operation.
-	 */
-	struct TempInfo {
-		PCNode *predPartial = nullptr, *nextPartial = nullptr;
-		PCNode* tpPred = nullptr;
-		PCNode* tpPartialPred = nullptr;
-		size_t tpPartialHeight = 0;
-		PCNode* tpSucc = nullptr;
-		std::vector<PCNode*> fullNeighbors;
-		PCNode *ebEnd1 = nullptr, *fbEnd1 = nullptr, *fbEnd2 = nullptr, *ebEnd2 = nullptr;
-
-		void replaceNeighbor(PCNode* oldNeigh, PCNode* newNeigh) {
-			if (tpPred == oldNeigh) {
-				tpPred = newNeigh;
-			}
-			if (tpPartialPred == oldNeigh) {
-				tpPartialPred = newNeigh;
-			}
-			if (tpSucc == oldNeigh) {
-				tpSucc = newNeigh;
-			}
-			if (ebEnd1 == oldNeigh) {
-				ebEnd1 = newNeigh;
-			}
-			if (ebEnd2 == oldNeigh) {
-				ebEnd2 = newNeigh;
-			}
-			if (fbEnd1 == oldNeigh) {
-				fbEnd1 = newNeigh;
-			}
-			if (fbEnd2 == oldNeigh) {
-				fbEnd2 = newNeigh;
-			}
-		}
-
-		void clear() {
-			nextPartial = predPartial = nullptr;
-			tpPred = tpPartialPred = tpSucc = nullptr;
-			ebEnd1 = fbEnd1 = fbEnd2 = ebEnd2 = nullptr;
-			tpPartialHeight = 0;
-			fullNeighbors.clear();
-		}
-	};
+	using TempInfo = PCNodeTempInfo;
 
-	using LeafUserData = std::array<void*, sizeof(TempInfo) / sizeof(void*)>;
+	//! Leaves need no temporary information, so instead they can store up to four pointers of user data.
+	using LeafUserData = std::array<void*, 4>;
 
 private:
 	// index in registry
@@ -121,9 +79,8 @@ private:
 	// global
 	PCTreeForest* m_forest;
 
-	// private
+	// private, the index in the C-node list of the forest for C-nodes or the leaf index for leaves
 	UnionFindIndex m_nodeListIndex = UNIONFINDINDEX_EMPTY;
-	PCNodeType m_nodeType;
 	PCNode* m_parentPNode = nullptr;
 	mutable UnionFindIndex m_parentCNodeId = UNIONFINDINDEX_EMPTY;
 	PCNode* m_sibling1 = nullptr;
@@ -131,35 +88,29 @@ private:
 	PCNode* m_child1 = nullptr;
 	PCNode* m_child2 = nullptr;
 	size_t m_childCount = 0;
-	mutable NodeLabel m_label = NodeLabel::Unknown;
 	mutable size_t m_timestamp = 0;
+	PCNodeType m_nodeType;
+	mutable NodeLabel m_label = NodeLabel::Unknown;
 
 	// leaves need no temp info, so they can easily store user data
+	// the temp info of other nodes is only valid if m_timestamp matches the one of the forest
 	union {
-		mutable TempInfo m_temp;
+		mutable TempInfo* m_temp;
 		LeafUserData m_userData;
 	};
 
 	PCNode(PCTreeForest* forest, size_t id, PCNodeType nodeType)
 		: IntrusiveList<PCNode>::node(), m_id(id), m_forest(forest), m_nodeType(nodeType) {
 		if (nodeType == PCNodeType::Leaf) {
-			new (&m_userData) LeafUserData;
+			m_userData = {};
 		} else {
-			new (&m_temp) TempInfo;
+			m_temp = nullptr;
 		}
 	}
 
 	OGDF_NO_COPY(PCNode)
 	OGDF_NO_MOVE(PCNode)
 
-	~PCNode() {
-		if (m_nodeType == PCNodeType::Leaf) {
-			m_userData.~array();
-		} else {
-			m_temp.~TempInfo();
-		}
-	}
-
 public:
 	/**
 	 * @name Tree structure methods
@@ -195,7 +146,10 @@ public:
 	/**
 	 * Reverse the stored order of children.
 	 */
-	void flip() { std::swap(m_child1, m_child2); }
+	void flip() {
+		recordState();
+		std::swap(m_child1, m_child2);
+	}
 
 	/**
 	 * Reorder all children according to the given range.
@@ -208,11 +162,14 @@ public:
 			OGDF_ASSERT(begin == end);
 			return;
 		}
-#ifdef OGDF_DEBUG
+#ifdef OGDF_HEAVY_DEBUG
 		std::set<PCNode*> set1(begin, end);
-		OGDF_ASSERT(set1.size() == getChildCount());
+		OGDF_HEAVY_ASSERT(set1.size() == getChildCount());
+#endif
+#ifdef OGDF_DEBUG
 		size_t count = 0;
 #endif
+		recordState();
 		PCNode* pred = nullptr;
 		PCNode* cur = nullptr;
 		for (It it = begin; it != end; ++it) {
@@ -222,6 +179,7 @@ public:
 			OGDF_ASSERT(isParentOf(cur));
 			count++;
 #endif
+			cur->recordState();
 			cur->m_sibling1 = pred;
 			if (pred) {
 				pred->m_sibling2 = cur;
@@ -279,16 +237,27 @@ private:
 	 */
 	void forceDetach();
 
+	/**
+	 * Save the current structure of this node to the undo log if a checkpoint is active.
+	 * Needs to be called before any of the structural fields are changed.
+	 * @sa PCTree::checkpoint()
+	 */
+	void recordState() {
+		(*m_forest->m_versionCounter)++;
+		if (m_forest->isRecording()) {
+			m_forest->recordNodeState(this);
+		}
+	}
+
 	/**
 	 * Overwrite the type of this node without updating any other data structures.
 	 */
 	void changeType(PCNodeType newType) {
+		recordState();
 		if (m_nodeType == PCNodeType::Leaf && newType != PCNodeType::Leaf) {
-			m_userData.~array();
-			new (&m_temp) TempInfo;
+			m_temp = m_forest->m_timestamp == m_timestamp ? m_forest->newTempInfo() : nullptr;
 		} else if (m_nodeType != PCNodeType::Leaf && newType == PCNodeType::Leaf) {
-			m_temp.~TempInfo();
-			new (&m_userData) LeafUserData;
+			m_userData = {};
 		}
 		m_nodeType = newType;
 	}
@@ -422,9 +391,14 @@ public:
 	//! @{
 
 	const TempInfo& constTempInfo() const {
-		checkTimestamp();
+		OGDF_ASSERT(isValidNode());
 		OGDF_ASSERT(!isLeaf());
-		return m_temp;
+		if (m_forest->m_timestamp != m_timestamp) {
+			// don't take a fresh temp info from the pool of the forest when only reading
+			static const TempInfo emptyTempInfo;
+			return emptyTempInfo;
+		}
+		return *m_temp;
 	}
 
 	bool isFull() const { return getLabel() == NodeLabel::Full; }
@@ -452,6 +426,18 @@ private:
 	}
 
 public:
+	/**
+	 * @return the index of this leaf within its tree, see PCTree::getLeafByIndex().
+	 *   Leaf indices are assigned consecutively when leaves are added to a tree, are never reused
+	 *   within the tree and, unlike index(), are not changed by PCTreeForest::compact().
+	 *   Copies of a tree use the same leaf indices, while leaves moved to another tree by
+	 *   PCTree::insertTree() get new ones.
+	 */
+	size_t getLeafIndex() const {
+		OGDF_ASSERT(isLeaf());
+		return m_nodeListIndex;
+	}
+
 	/**
 	 * @return the user data that can be stored in leaves
 	 */
@@ -469,33 +455,34 @@ public:
 	}
 
 private:
-	void checkTimestamp() const;
+	//! Reset the temp info if it is from a previous update, allocating a new one for inner nodes.
+	void checkTimestamp();
 
 	TempInfo& tempInfo() {
 		checkTimestamp();
 		OGDF_ASSERT(!isLeaf());
-		return m_temp;
+		return *m_temp;
 	}
 
 	size_t addFullNeighbor(PCNode* fullNeigh) {
 		checkTimestamp();
 		OGDF_ASSERT(!isLeaf());
 		OGDF_ASSERT(fullNeigh->isFull());
-		m_temp.fullNeighbors.push_back(fullNeigh);
-		return m_temp.fullNeighbors.size();
+		m_temp->fullNeighbors.push_back(fullNeigh);
+		return m_temp->fullNeighbors.size();
 	}
 
 	PCNode*& getFullNeighInsertionPoint(PCNode* nonFullNeigh) {
 		checkTimestamp();
 		OGDF_ASSERT(!isLeaf());
 		OGDF_ASSERT(nonFullNeigh != nullptr);
-		if (nonFullNeigh == m_temp.ebEnd1) {
-			OGDF_ASSERT(areNeighborsAdjacent(m_temp.ebEnd1, m_temp.fbEnd1));
-			return m_temp.fbEnd1;
+		if (nonFullNeigh == m_temp->ebEnd1) {
+			OGDF_ASSERT(areNeighborsAdjacent(m_temp->ebEnd1, m_temp->fbEnd1));
+			return m_temp->fbEnd1;
 		} else {
-			OGDF_ASSERT(nonFullNeigh == m_temp.ebEnd2);
-			OGDF_ASSERT(areNeighborsAdjacent(m_temp.ebEnd2, m_temp.fbEnd2));
-			return m_temp.fbEnd2;
+			OGDF_ASSERT(nonFullNeigh == m_temp->ebEnd2);
+			OGDF_ASSERT(areNeighborsAdjacent(m_temp->ebEnd2, m_temp->fbEnd2));
+			return m_temp->fbEnd2;
 		}
 	}
 
@@ -37,12 +37,17 @@
 #include <pctree/PCTreeForest.h>
 #include <pctree/PCTreeIterators.h>
 #include <pctree/util/IntrusiveList.h>
+#include <pctree/util/OrderStatisticsTree.h>
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <list>
+#include <memory>
 #include <sstream>
+#include <string_view>
 #include <vector>
 
 namespace pc_tree {
@@ -128,10 +133,15 @@ private:
 	size_t m_pNodeCount = 0;
 	size_t m_cNodeCount = 0;
 	IntrusiveList<PCNode> m_leaves;
+	//! The leaves indexed by their PCNode::getLeafIndex(), \c nullptr for leaves that were removed.
+	std::vector<PCNode*> m_leavesByIndex;
 
 	// needs special merge
 	PCNode* m_rootNode = nullptr;
 
+	//! Incremented on structural changes made by the methods of this tree, see StructureChange.
+	size_t m_structureVersion = 0;
+
 	// temp makeConsecutive variables
 	size_t m_partialCount = 0;
 	size_t m_terminalPathLength = 0;
@@ -141,6 +151,22 @@ private:
 	bool m_apexCandidateIsFix = false;
 	PCNode* m_apexTPPred2 = nullptr;
 
+	struct LeafOrderCache {
+		//! The leaf indices of all leaves in their current order.
+		OrderStatisticsTree m_leafIndices;
+		//! The leaves listed from #m_leafIndices, only up to date if #m_orderValid.
+		std::vector<PCNode*> m_order;
+		bool m_orderValid = false;
+		//! Scratch space for the leaf indices of the block that is updated.
+		std::vector<size_t> m_block;
+		//! The PCTree::m_structureVersion for which #m_leafIndices is valid.
+		size_t m_version = 0;
+		//! The PCTreeForest::m_structureVersion for which #m_leafIndices is valid.
+		size_t m_forestVersion = 0;
+	};
+
+	std::unique_ptr<LeafOrderCache> m_leafOrderCache;
+
 	// private
 	bool m_externalForest = true;
 	std::list<Observer*> m_observers;
@@ -168,6 +194,7 @@ public:
 	/**
 	 * Convenience method generating a PCTree consisting of a single P-node with \p leafNum leaves, which are all copied to the optional list \p added.
 	 * Automatically creates and manages a forest if \p forest is null.
+	 * The leaves get the leaf indices 0 to \p leafNum - 1 in the order of \p added, see makeConsecutiveByLeafIndex().
 	 */
 	explicit PCTree(int leafNum, std::vector<PCNode*>* added = nullptr,
 			PCTreeForest* forest = nullptr);
@@ -184,11 +211,29 @@ public:
 
 	/**
 	 * Deserialize a PCTree from a string \p str as generated by operator<<(std::ostream&, const PCTree*) or PCTree::uniqueID().
+	 * The string is parsed in a single pass.
 	 * Automatically creates and manages a forest if \p forest is null.
+	 * @throws std::invalid_argument if \p str is not a valid serialized PC-tree.
 	 */
-	explicit PCTree(const std::string& str, PCTreeNodeArray<std::string>* nodeLabels = nullptr,
+	explicit PCTree(std::string_view str, PCTreeNodeArray<std::string>* nodeLabels = nullptr,
 			bool keep_ids = false, PCTreeForest* forest = nullptr);
 
+	/**
+	 * Deserialize a PCTree from the text read from \p is, see PCTree(std::string_view, PCTreeNodeArray<std::string>*, bool, PCTreeForest*).
+	 * The stream is consumed in fixed-size chunks, so its whole content never needs to be held in memory.
+	 */
+	explicit PCTree(std::istream& is, PCTreeNodeArray<std::string>* nodeLabels = nullptr,
+			bool keep_ids = false, PCTreeForest* forest = nullptr);
+
+	/**
+	 * Deserialize a PCTree from the \p size bytes at \p data as generated by writeBinary(),
+	 * using a single pass over the nodes.
+	 * Automatically creates and manages a forest if \p forest is null.
+	 * @throws std::invalid_argument if \p data is not a valid serialized PC-tree.
+	 */
+	explicit PCTree(const std::byte* data, size_t size, bool keep_ids = false,
+			PCTreeForest* forest = nullptr);
+
 	virtual ~PCTree();
 
 	//! Moving would break backreferences from nodes, so is disallowed
@@ -210,7 +255,13 @@ public:
 	 * @param id ID for the new node, or -1 to automatically use the next free one.
 	 * @return the new node
 	 */
-	PCNode* newNode(PCNodeType type, PCNode* parent = nullptr, int id = -1);
+	PCNode* newNode(PCNodeType type, PCNode* parent = nullptr, int id = -1) {
+		return newNode<ObserverList>(type, parent, id);
+	}
+
+	//! Variant of newNode() that notifies observers via the static policy \p Observers.
+	template<typename Observers>
+	PCNode* newNode(PCNodeType type, PCNode* parent, int id);
 
 	/**
 	 * @copydoc destroyNode(PCNode* const&)
@@ -229,6 +280,9 @@ public:
 
 	/**
 	 * Attach \p count leaves to P- or C-node \p parent and optionally store the new leaves in a vector \p added.
+	 *
+	 * The leaves get consecutive IDs and are appended to \p parent in this order as a single chain of
+	 * siblings. All registered PCTreeNodeArray instances are resized at most once.
 	 */
 	void insertLeaves(int count, PCNode* parent, std::vector<PCNode*>* added = nullptr);
 
@@ -310,16 +364,29 @@ public:
 	/**
 	 * Insert tree \p tree into this tree at node \p at.
 	 *
-	 * Both trees need to be part of the same forest. All observers of \p tree will be moved to this tree.
+	 * All observers of \p tree will be moved to this tree.
 	 * If \p at is a leaf, it will be replaced by \p tree, otherwise \p tree will be appended as child of \p at.
+	 * Afterwards, \p tree is deleted.
+	 *
+	 * If \p tree is part of a different forest, it is copied into the forest of this tree in time linear in its size,
+	 * so its nodes are replaced by new ones. In this case, \p tree may not have any observers.
+	 *
+	 * If \p mapping is not null, it is assigned a mapping from the former index() of each node of \p tree to
+	 * the node of this tree that represents it, or \c nullptr for nodes that are removed by the insertion.
+	 * It is indexed by IDs as all nodes of \p tree are invalid afterwards if they were copied, and the forest
+	 * of \p tree might even be deleted together with it.
 	 */
-	void insertTree(PCNode* at, PCTree* tree);
+	void insertTree(PCNode* at, PCTree* tree, std::vector<PCNode*>* mapping = nullptr);
 
 private:
 	void unregisterNode(PCNode* node);
 
 	void registerNode(PCNode* node);
 
+	//! Builds this tree from the text notation provided by \p source, used by the deserializing constructors.
+	template<typename Source>
+	void parse(Source& source, PCTreeNodeArray<std::string>* nodeLabels, bool keep_ids);
+
 	//! @}
 
 public:
@@ -351,15 +418,15 @@ public:
 	 */
 	template<typename It>
 	bool makeConsecutive(It begin, It end) {
-		FullLeafIter iter = [&begin, &end]() { return NextFullLeaf<It>(begin, end); };
-		for (auto obs : m_observers) {
-			obs->makeConsecutiveCalled(*this, iter);
+		if (hasObservers()) {
+			FullLeafIter iter = [&begin, &end]() { return NextFullLeaf<It>(begin, end); };
+			ObserverList::makeConsecutiveCalled(*this, iter);
 		}
 
 		OGDF_HEAVY_ASSERT(checkValid());
 		resetTempData();
 
-#ifdef OGDF_DEBUG
+#ifdef OGDF_HEAVY_DEBUG
 		for (auto it = begin; it != end; ++it) {
 			PCNode* leaf = *it;
 			OGDF_ASSERT(leaf);
@@ -368,24 +435,107 @@ public:
 		}
 #endif
 		if (isTrivialRestriction(end - begin)) {
-			for (auto obs : m_observers) {
-				obs->makeConsecutiveDone(*this, Observer::Stage::Trivial, true);
-			}
+			ObserverList::makeConsecutiveDone(*this, Observer::Stage::Trivial, true);
 			return true;
 		}
 
-		// PC_PROFILE_ENTER(1, "label");
+		PCTREE_PROFILE_BEGIN(MarkFull);
 		markFull(begin, end);
-		// PC_PROFILE_EXIT(1, "label");
+		PCTREE_PROFILE_END(MarkFull);
 
 		return makeFullNodesConsecutive();
 	}
 
+	bool makeConsecutiveByLeafIndex(const std::vector<size_t>& leafIndices) {
+		return makeConsecutiveByLeafIndex(leafIndices.begin(), leafIndices.end());
+	}
+
+	/**
+	 * Make the leaves whose PCNode::getLeafIndex() is contained in the range denoted by iterators
+	 * \p begin (inclusive) to \p end (exclusive) consecutive in all represented orders.
+	 * The leaves are looked up via getLeafByIndex(), so callers that keep their restrictions as
+	 * plain indices don't need to maintain their own mapping to the PCNode pointers.
+	 * @throws std::invalid_argument if an index does not belong to a leaf of this tree, in which
+	 *   case the tree is not changed.
+	 * @sa makeConsecutive(It, It)
+	 */
+	template<typename It>
+	bool makeConsecutiveByLeafIndex(It begin, It end) {
+		for (It it = begin; it != end; ++it) {
+			checkLeafIndex(*it);
+		}
+		return makeConsecutive(LeafByIndex<It>(&m_leavesByIndex, begin),
+				LeafByIndex<It>(&m_leavesByIndex, end));
+	}
+
+	bool makeConsecutiveBitset(const std::vector<uint64_t>& words) {
+		return makeConsecutiveBitset(words.data(), words.size());
+	}
+
+	/**
+	 * Make the leaves whose PCNode::getLeafIndex() is set in the bitset \p words consecutive in all
+	 * represented orders.
+	 * Bit \c i of word \c j corresponds to the leaf with index <tt>64 * j + i</tt>.
+	 * This is particularly useful for dense restrictions, as the set bits are enumerated directly
+	 * while marking the leaves full.
+	 * @throws std::invalid_argument if a set bit does not belong to a leaf of this tree, in which
+	 *   case the tree is not changed.
+	 * @sa makeConsecutive(It, It)
+	 */
+	bool makeConsecutiveBitset(const uint64_t* words, size_t wordCount);
+
+	bool canMakeConsecutive(std::initializer_list<PCNode*> consecutiveLeaves) {
+		return canMakeConsecutive(consecutiveLeaves.begin(), consecutiveLeaves.end());
+	}
+
+	bool canMakeConsecutive(const std::vector<PCNode*>& consecutiveLeaves) {
+		return canMakeConsecutive(consecutiveLeaves.begin(), consecutiveLeaves.end());
+	}
+
+	/**
+	 * Check whether the leaves contained in the range denoted by iterators \p begin (inclusive) to
+	 * \p end (exclusive) can be made consecutive without actually changing the tree.
+	 * Only the labelling and the search for the terminal path of makeConsecutive() are performed,
+	 * so the temporary information is overwritten, but the tree structure stays untouched.
+	 * Observers are not notified.
+	 * @return \c true if makeConsecutive() with the same leaves would succeed.
+	 */
+	template<typename It>
+	bool canMakeConsecutive(It begin, It end) {
+		OGDF_HEAVY_ASSERT(checkValid());
+		resetTempData();
+		if (isTrivialRestriction(end - begin)) {
+			return true;
+		}
+		markFull(begin, end);
+		return canMakeFullNodesConsecutive();
+	}
+
+	/**
+	 * Apply multiple restrictions given in compressed sparse row format, that is restriction \c i
+	 * consists of the leaves <tt>leaves[offsets[i]]</tt> (inclusive) to <tt>leaves[offsets[i+1]]</tt> (exclusive).
+	 * This is equivalent to calling makeConsecutive() for each restriction in order, but avoids most
+	 * of the per-call overhead, especially if no observers are registered.
+	 *
+	 * @param offsets the start offset of each restriction, followed by <tt>leaves.size()</tt>.
+	 * @param leaves the leaves of all restrictions.
+	 * @param continueOnFailure whether the remaining restrictions should still be applied after
+	 *    one failed. Failing restrictions never change the tree.
+	 * @param failed if given, the indices of all failed restrictions are appended to this vector.
+	 * @return the index of the first restriction that failed, or the number of restrictions if all
+	 *    were applied successfully.
+	 */
+	size_t makeConsecutiveBatch(const std::vector<size_t>& offsets,
+			const std::vector<PCNode*>& leaves, bool continueOnFailure = false,
+			std::vector<size_t>* failed = nullptr);
+
 	/**
 	 * Reset all makeConsecutive()-related temporary information, especially which leaves are full (should be made consecutive).
 	 */
 	void resetTempData() {
+		OGDF_ASSERT(!m_forest->isFrozen());
 		m_forest->m_timestamp++;
+		m_forest->releaseTempInfos();
 		m_firstPartial = m_lastPartial = nullptr;
 		m_partialCount = 0;
 		m_apexCandidate = nullptr;
@@ -436,19 +586,130 @@ public:
 	 * @return \c true if the update was successful, \c false if the leaves cannot be made
 	 *    consecutive and the tree was left unchanged.
 	 */
+	bool makeFullNodesConsecutive() {
+		return hasObservers() ? makeFullNodesConsecutive<ObserverList>()
+							  : makeFullNodesConsecutive<NoObservers>();
+	}
+
+	/**
+	 * Variant of makeFullNodesConsecutive() that notifies observers via the static policy
+	 * \p Observers, so that the update contains no notifications at all for NoObservers.
+	 * Only instantiated for NoObservers and ObserverList.
+	 */
+	template<typename Observers>
 	bool makeFullNodesConsecutive();
 
+	/**
+	 * Checks whether makeFullNodesConsecutive() would succeed, but only searches for the terminal
+	 * path instead of changing the tree.
+	 * Requires labels of parents to be correctly set by markFull(It, It, std::vector<PCNode*>*).
+	 */
+	bool canMakeFullNodesConsecutive();
+
 private:
 	/* see the paper for more info on how the update works with the following methods */
 
 	PCNode* markFull(PCNode* full_node, std::vector<PCNode*>* fullNodeOrder = nullptr);
 
+	//! Throw if \p index is not the PCNode::getLeafIndex() of a leaf of this tree.
+	void checkLeafIndex(size_t index) const;
+
+	/**
+	 * Random access iterator adaptor that maps the leaf indices returned by \p It to the leaves of a
+	 * tree. All indices need to be validated with checkLeafIndex() beforehand.
+	 */
+	template<typename It>
+	struct LeafByIndex {
+		const std::vector<PCNode*>* m_leaves;
+		It m_it;
+
+		LeafByIndex(const std::vector<PCNode*>* leaves, It it) : m_leaves(leaves), m_it(it) { }
+
+		PCNode* operator*() const {
+			PCNode* leaf = (*m_leaves)[*m_it];
+			OGDF_ASSERT(leaf != nullptr);
+			return leaf;
+		}
+
+		LeafByIndex& operator++() {
+			++m_it;
+			return *this;
+		}
+
+		bool operator==(const LeafByIndex& other) const { return m_it == other.m_it; }
+
+		bool operator!=(const LeafByIndex& other) const { return m_it != other.m_it; }
+
+		auto operator-(const LeafByIndex& other) const { return m_it - other.m_it; }
+	};
+
+	/**
+	 * While an instance exists, structural changes to any node of the forest of \p tree only
+	 * increment the PCTree::m_structureVersion of \p tree instead of that of the whole forest,
+	 * so that they don't invalidate the cachedLeafOrder() of other trees.
+	 * Only used around methods that change nothing but \p tree, and not at all while observers
+	 * are registered, as they might change other trees when notified.
+	 */
+	class StructureChange {
+		PCTreeForest* m_forest;
+		size_t* m_previous;
+
+	public:
+		explicit StructureChange(PCTree& tree)
+			: m_forest(tree.m_forest), m_previous(m_forest->m_versionCounter) {
+			if (!tree.hasObservers()) {
+				m_forest->m_versionCounter = &tree.m_structureVersion;
+			}
+		}
+
+		~StructureChange() { m_forest->m_versionCounter = m_previous; }
+
+		OGDF_NO_COPY(StructureChange)
+		OGDF_NO_MOVE(StructureChange)
+	};
+
+	/**
+	 * The block of cachedLeafOrder() that is changed by the current update, which is removed from
+	 * the order before the update and inserted again afterwards.
+	 */
+	struct LeafOrderBlock {
+		bool m_valid = false;
+		//! The node whose children contain the block, or \c nullptr if the order is recomputed.
+		PCNode* m_parent = nullptr;
+		//! A leaf of the single child of #m_parent containing the block, or \c nullptr if the block
+		//! consists of all children between #m_before and #m_after.
+		PCNode* m_anchor = nullptr;
+		//! The child of #m_parent preceding the block in the order, or \c nullptr if there is none.
+		PCNode* m_before = nullptr;
+		//! The sibling of #m_before that is not part of the block.
+		PCNode* m_beforePred = nullptr;
+		//! The child of #m_parent following the block in the order, or \c nullptr if there is none.
+		PCNode* m_after = nullptr;
+		//! The child following the part of the block that wrapped around to the front of the order.
+		PCNode* m_wrapAfter = nullptr;
+		//! The position of the block in the order.
+		size_t m_begin = 0;
+		//! The number of leaves in the block.
+		size_t m_size = 0;
+		//! The number of leaves of the block at the front of the order, if the block wraps around.
+		size_t m_wrapSize = 0;
+	};
+
+	LeafOrderCache& validLeafOrderCache();
+
+	LeafOrderBlock findLeafOrderBlock();
+
+	void updateLeafOrderBlock(const LeafOrderBlock& block);
+
 	bool findTerminalPath();
 
+	template<typename Observers>
 	void updateSingletonTerminalPath();
 
+	template<typename Observers>
 	PCNode* createCentralNode();
 
+	template<typename Observers>
 	int updateTerminalPath(PCNode* central, PCNode* tpNeigh);
 
 	// labeling / TP finding
@@ -469,10 +730,48 @@ private:
 	void replaceTPNeigh(PCNode* central, PCNode* oldTPNeigh, PCNode* newTPNeigh,
 			PCNode* newFullNeigh, PCNode* otherEndOfFullBlock);
 
+	template<typename Observers>
 	PCNode* splitOffFullPNode(PCNode* node, bool skip_parent);
 
 	//! @}
 
+public:
+	/**
+	 * @name Checkpoints
+	 * These methods allow reverting changes to the tree, e.g. for backtracking searches, in time
+	 * proportional to the number of changes instead of copying the whole tree.
+	 * While a checkpoint is active, all structural changes made to this tree are recorded in an undo
+	 * log of its forest, the storage of destroyed nodes is only released once all checkpoints are
+	 * committed, and the union-find structure for C-node parents does no path compression.
+	 * No other tree of the same forest may be changed, and intersect(), insertTree() and
+	 * PCTreeForest::clear() may not be used in the meantime.
+	 * Observers are not notified when changes are reverted.
+	 */
+	//! @{
+
+	/**
+	 * Create a checkpoint of the current state of this tree. Checkpoints can be nested.
+	 */
+	void checkpoint();
+
+	/**
+	 * Revert all changes made since the most recent active checkpoint and remove that checkpoint.
+	 * Nodes created in the meantime are destroyed, destroyed nodes are brought back, and
+	 * all temporary information is reset.
+	 */
+	void rollback();
+
+	/**
+	 * Keep all changes made since the most recent active checkpoint and remove that checkpoint.
+	 * The changes can still be reverted by rolling back an enclosing checkpoint.
+	 */
+	void commit();
+
+	//! The number of active checkpoints of this tree.
+	[[nodiscard]] size_t getCheckpointCount() const;
+
+	//! @}
+
 public:
 	/**
 	 * @name Intersect
@@ -488,13 +787,9 @@ public:
 
 private:
 	bool findNodeRestrictions(PCTree& applyTo, PCTreeNodeArray<PCNode*>& mapping,
-			PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
-			PCTreeNodeArray<std::vector<PCNode*>>& subtreeNodes,
-			PCTreeNodeArray<PCNode*>& leafPartner, PCTreeNodeArray<bool>& isFront);
+			PCTreeForest::IntersectScratch& scratch);
 
-	void restoreSubtrees(PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
-			PCTreeNodeArray<std::vector<PCNode*>>& subtreeNodes,
-			PCTreeNodeArray<PCNode*>& leafPartner, PCTreeNodeArray<bool>& isFront);
+	void restoreSubtrees(PCTreeForest::IntersectScratch& scratch);
 
 	//! @}
 
@@ -515,6 +810,17 @@ public:
 
 	[[nodiscard]] size_t getLeafCount() const { return m_leaves.size(); };
 
+	/**
+	 * @return the leaf of this tree with the given PCNode::getLeafIndex(), or \c nullptr if there is
+	 *   no such leaf (anymore).
+	 * As leaf indices are never reused, the table behind this holds one pointer for every leaf that
+	 * was ever added to this tree, including those removed again by replaceLeaf(), insertTree() or
+	 * the placeholders of intersect(). It is not shrunk by PCTreeForest::compact().
+	 */
+	[[nodiscard]] PCNode* getLeafByIndex(size_t index) const {
+		return index < m_leavesByIndex.size() ? m_leavesByIndex[index] : nullptr;
+	}
+
 	[[nodiscard]] size_t getPNodeCount() const { return m_pNodeCount; }
 
 	[[nodiscard]] size_t getCNodeCount() const { return m_cNodeCount; }
@@ -533,17 +839,19 @@ public:
 	int getTerminalPathLength() const { return m_terminalPathLength; }
 
 	//! An iterable through all nodes of this PCTree.
-	FilteringPCTreeDFS allNodes() const { return FilteringPCTreeDFS(*this, m_rootNode); }
+	FilteringPCTreeWalk<true, false, AllPCNodes> allNodes() const {
+		return FilteringPCTreeWalk<true, false, AllPCNodes>(*this, m_rootNode);
+	}
 
 	//! An iterable through all inner (non-leaf) nodes of this PCTree.
-	FilteringPCTreeDFS innerNodes() const {
-		return FilteringPCTreeDFS(*this, m_rootNode, [](PCNode* node) { return !node->isLeaf(); });
+	FilteringPCTreeWalk<true, false, InnerPCNodes, AllPCNodes> innerNodes() const {
+		return FilteringPCTreeWalk<true, false, InnerPCNodes, AllPCNodes>(*this, m_rootNode);
 	}
 
 	//! Store the order of leaves currently represented by this tree in \p container.
 	template<typename Container>
 	void currentLeafOrder(Container& container) const {
-		for (PCNode* leaf : FilteringPCTreeDFS(*this, m_rootNode)) {
+		for (PCNode* leaf : allNodes()) {
 			if (leaf->isLeaf()) {
 				container.push_back(leaf);
 			}
@@ -557,6 +865,35 @@ public:
 		return container;
 	}
 
+	/**
+	 * The same order of leaves as returned by currentLeafOrder(), but stored by this tree and updated
+	 * incrementally by makeConsecutive() and its variants. The order is kept in an
+	 * OrderStatisticsTree over the leaves, from which only the leaves below the full and partial
+	 * children of the apex of the terminal path are removed and inserted again. This takes expected
+	 * time logarithmic in the number of leaves plus linear in the depth of the tree per child, and
+	 * linear in the size of the subtrees of these children.
+	 * Only if the apex is replaced, i.e. if it is a P-node with a full parent or at most one empty
+	 * neighbor, or a C-node with a full parent, the whole subtree of the apex is updated, or the
+	 * whole order is recomputed on the next call if the apex is the root.
+	 * Listing the order after an update takes linear time, but no traversal of the tree.
+	 * Other changes to this tree, as well as direct changes to PCNode%s and changes to trees with
+	 * observers in the same forest, cause the order to be recomputed on the next call.
+	 * Once this was called, makeConsecutive() maintains the order until clearLeafOrderCache() is called.
+	 */
+	const std::vector<PCNode*>& cachedLeafOrder();
+
+	/**
+	 * The index of \p leaf in cachedLeafOrder() in expected time logarithmic in the number of
+	 * leaves, unless the order needs to be recomputed. Does not list the order.
+	 */
+	size_t getLeafPosition(PCNode* leaf) {
+		OGDF_ASSERT(leaf->isLeaf());
+		return validLeafOrderCache().m_leafIndices.position(leaf->getLeafIndex());
+	}
+
+	//! Release the memory of cachedLeafOrder() and stop maintaining it.
+	void clearLeafOrderCache() { m_leafOrderCache.reset(); }
+
 	//! Validity check for debugging assertions.
 	bool checkValid(bool allow_small_deg = true) const;
 
@@ -627,11 +964,11 @@ public:
 	 */
 	std::ostream& uniqueID(std::ostream& os,
 			const std::function<void(std::ostream& os, PCNode*, int)>& printNode = uid_utils::nodeToID,
-			const std::function<bool(PCNode*, PCNode*)>& compareNodes = uid_utils::compareNodesByID);
+			const std::function<bool(PCNode*, PCNode*)>& compareNodes = uid_utils::compareNodesByID) const;
 
 	std::string uniqueID(
 			const std::function<void(std::ostream& os, PCNode*, int)>& printNode = uid_utils::nodeToID,
-			const std::function<bool(PCNode*, PCNode*)>& compareNodes = uid_utils::compareNodesByID) {
+			const std::function<bool(PCNode*, PCNode*)>& compareNodes = uid_utils::compareNodesByID) const {
 		std::stringstream sb;
 		uniqueID(sb, printNode, compareNodes);
 		return sb.str();
@@ -646,17 +983,47 @@ public:
 	std::ostream& uniqueIDRooted(std::ostream& os,
 			const std::function<void(std::ostream& os, PCNode*, int)>& printNode = uid_utils::nodeToID,
 			const std::function<bool(PCNode*, PCNode*)>& compareNodes = uid_utils::compareNodesByID,
-			bool print_root = true);
+			bool print_root = true) const;
 
 	std::string uniqueIDRooted(
 			const std::function<void(std::ostream& os, PCNode*, int)>& printNode = uid_utils::nodeToID,
 			const std::function<bool(PCNode*, PCNode*)>& compareNodes = uid_utils::compareNodesByID,
-			bool print_root = true) {
+			bool print_root = true) const {
 		std::stringstream sb;
 		uniqueIDRooted(sb, printNode, compareNodes, print_root);
 		return sb.str();
 	}
 
+	/**
+	 * Compute a 64 bit hash of the structure of this PCTree that, like uniqueID() with uid_utils::leafToID, only
+	 * depends on the set of represented leaf orders. It is thus independent of which node the tree is rooted at,
+	 * the IDs of inner nodes and the current order of children, which makes it suitable for deduplicating
+	 * equivalent trees. Leaves are identified by their PCNode::getLeafIndex(), so the hash is neither
+	 * changed by PCTreeForest::compact() nor does it depend on the forest of the tree.
+	 * Runs in time linear in the size of this tree without building a string, but different trees
+	 * may collide.
+	 */
+	uint64_t canonicalHash() const;
+
+	/**
+	 * Write this tree in a compact binary format to \p os, which can be read by PCTree(const std::byte*, size_t, bool, PCTreeForest*) or loadBinary().
+	 * After a header consisting of the magic number \c PCTB (as native-endian 32 bit integer), the format version and the number of nodes (64 bit),
+	 * the format consists of three arrays with one entry per node, listing the nodes in pre-order with children in their stored order:
+	 * the 32 bit ID of each node, the 32 bit index of the parent (or \c UINT32_MAX for the root), and the 8 bit PCNodeType.
+	 * @throws std::overflow_error if the IDs or the number of nodes do not fit into 32 bits.
+	 */
+	void writeBinary(std::ostream& os) const;
+
+	/**
+	 * Deserialize a PCTree from the file at \p path as generated by writeBinary().
+	 * The file is memory-mapped if supported by the platform, otherwise it is read into memory.
+	 * Automatically creates and manages a forest if \p forest is null.
+	 * @throws std::runtime_error if the file cannot be read.
+	 * @throws std::invalid_argument if the file content is not a valid serialized PC-tree.
+	 */
+	static std::unique_ptr<PCTree> loadBinary(const std::string& path, bool keep_ids = false,
+			PCTreeForest* forest = nullptr);
+
 	//! @}
 
 public:
@@ -747,6 +1114,139 @@ public:
 		void makeConsecutiveDone(PCTree& tree, Stage stage, bool success) override;
 	};
 
+	/**
+	 * Observer policy for makeFullNodesConsecutive() that notifies nobody, so that the update
+	 * compiles without any notifications.
+	 */
+	struct NoObservers {
+		static void onNodeCreate(PCTree&, PCNode*) {}
+
+		static void makeConsecutiveCalled(PCTree&, const FullLeafIter&) {}
+
+		static void labelsAssigned(PCTree&, PCNode*, PCNode*, int) {}
+
+		static void terminalPathFound(PCTree&, PCNode*, PCNode*, int) {}
+
+		static void centralCreated(PCTree&, PCNode*) {}
+
+		static void beforeMerge(PCTree&, int, PCNode*) {}
+
+		static void afterMerge(PCTree&, PCNode*, PCNode*) {}
+
+		static void whenPNodeMerged(PCTree&, PCNode*, PCNode*, PCNode*) {}
+
+		static void whenCNodeMerged(PCTree&, PCNode*, bool, PCNode*, PCNode*) {}
+
+		static void fullNodeSplit(PCTree&, PCNode*) {}
+
+		static void makeConsecutiveDone(PCTree&, Observer::Stage, bool) {}
+
+		static void onApexMoved(PCTree&, PCNode*, PCNode*, PCNode*) {}
+
+		static void nodeDeleted(PCTree&, PCNode*) {}
+
+		static void nodeReplaced(PCTree&, PCNode*, PCNode*) {}
+	};
+
+	//! Observer policy for makeFullNodesConsecutive() that notifies all registered Observer%s.
+	struct ObserverList {
+		static void onNodeCreate(PCTree& tree, PCNode* node) {
+			for (Observer* obs : tree.m_observers) {
+				obs->onNodeCreate(node);
+			}
+		}
+
+		static void makeConsecutiveCalled(PCTree& tree, const FullLeafIter& consecutiveLeaves) {
+			for (Observer* obs : tree.m_observers) {
+				obs->makeConsecutiveCalled(tree, consecutiveLeaves);
+			}
+		}
+
+		static void labelsAssigned(PCTree& tree, PCNode* firstPartial, PCNode* lastPartial,
+				int partialCount) {
+			for (Observer* obs : tree.m_observers) {
+				obs->labelsAssigned(tree, firstPartial, lastPartial, partialCount);
+			}
+		}
+
+		static void terminalPathFound(PCTree& tree, PCNode* apex, PCNode* apexTPPred2,
+				int terminalPathLength) {
+			for (Observer* obs : tree.m_observers) {
+				obs->terminalPathFound(tree, apex, apexTPPred2, terminalPathLength);
+			}
+		}
+
+		static void centralCreated(PCTree& tree, PCNode* central) {
+			for (Observer* obs : tree.m_observers) {
+				obs->centralCreated(tree, central);
+			}
+		}
+
+		static void beforeMerge(PCTree& tree, int count, PCNode* tpNeigh) {
+			for (Observer* obs : tree.m_observers) {
+				obs->beforeMerge(tree, count, tpNeigh);
+			}
+		}
+
+		static void afterMerge(PCTree& tree, PCNode* successor, PCNode* mergedNode) {
+			for (Observer* obs : tree.m_observers) {
+				obs->afterMerge(tree, successor, mergedNode);
+			}
+		}
+
+		static void whenPNodeMerged(PCTree& tree, PCNode* tpNeigh, PCNode* tpPred,
+				PCNode* fullNeigh) {
+			for (Observer* obs : tree.m_observers) {
+				obs->whenPNodeMerged(tree, tpNeigh, tpPred, fullNeigh);
+			}
+		}
+
+		static void whenCNodeMerged(PCTree& tree, PCNode* tpNeigh, bool tpNeighSiblingsFlipped,
+				PCNode* fullNeigh, PCNode* fullOuterChild) {
+			for (Observer* obs : tree.m_observers) {
+				obs->whenCNodeMerged(tree, tpNeigh, tpNeighSiblingsFlipped, fullNeigh,
+						fullOuterChild);
+			}
+		}
+
+		static void fullNodeSplit(PCTree& tree, PCNode* fullNode) {
+			for (Observer* obs : tree.m_observers) {
+				obs->fullNodeSplit(tree, fullNode);
+			}
+		}
+
+		static void makeConsecutiveDone(PCTree& tree, Observer::Stage stage, bool success) {
+			for (Observer* obs : tree.m_observers) {
+				obs->makeConsecutiveDone(tree, stage, success);
+			}
+		}
+
+		static void onApexMoved(PCTree& tree, PCNode* apexCandidate, PCNode* central,
+				PCNode* parent) {
+			for (Observer* obs : tree.m_observers) {
+				obs->onApexMoved(tree, apexCandidate, central, parent);
+			}
+		}
+
+		static void nodeDeleted(PCTree& tree, PCNode* toBeDeleted) {
+			for (Observer* obs : tree.m_observers) {
+				obs->nodeDeleted(tree, toBeDeleted);
+			}
+		}
+
+		static void nodeReplaced(PCTree& tree, PCNode* replaced, PCNode* replacement) {
+			for (Observer* obs : tree.m_observers) {
+				obs->nodeReplaced(tree, replaced, replacement);
+			}
+		}
+	};
+
+	/**
+	 * @return whether any observer is registered.
+	 * Updates only use the ObserverList policy if this is the case and NoObservers otherwise.
+	 */
+	bool hasObservers() const { return !m_observers.empty(); }
+
 	std::list<Observer*>::const_iterator addObserver(Observer* observer) {
 		m_observers.push_back(observer);
 		return --m_observers.end();
@@ -0,0 +1,101 @@
+/** \file
+ * \brief Parallel solver for many independent consecutive-ones instances.
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#pragma once
+
+#include <pctree/util/defines.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pc_tree {
+/**
+ * An instance of the consecutive-ones problem, given as the leaves \c 0 to \c leafCount-1 of a PCTree
+ * and restrictions in compressed sparse row format. That is, restriction \c i consists of the leaf indices
+ * <tt>leaves[offsets[i]]</tt> (inclusive) to <tt>leaves[offsets[i+1]]</tt> (exclusive), see PCTree::makeConsecutiveBatch().
+ * No restriction may contain the same leaf twice.
+ */
+struct OGDF_EXPORT C1PInstance {
+	int leafCount = 0;
+	std::vector<size_t> offsets {0};
+	std::vector<int> leaves;
+
+	size_t getRestrictionCount() const { return offsets.size() - 1; }
+
+	void addRestriction(const std::vector<int>& restriction) {
+		leaves.insert(leaves.end(), restriction.begin(), restriction.end());
+		offsets.push_back(leaves.size());
+	}
+};
+
+//! The result of solving a single C1PInstance.
+struct OGDF_EXPORT C1PResult {
+	//! The index of the first restriction that could not be applied, or the number of restrictions if all were applied.
+	size_t firstFailed = 0;
+	//! If requested and all restrictions could be applied, a permutation of the leaf indices that satisfies all of them.
+	std::vector<int> order;
+
+	bool isConsecutive(const C1PInstance& instance) const {
+		return firstFailed == instance.getRestrictionCount();
+	}
+};
+
+/**
+ * Solves many independent C1PInstance%s in parallel.
+ * Each worker thread owns a PCTreeForest that is cleared and reused for all instances it solves, so that
+ * no memory needs to be allocated for the trees once the forest's storage has grown large enough.
+ * The instances are initially split evenly among the workers, and workers that run out of instances
+ * steal half of the remaining instances of another worker.
+ */
+class OGDF_EXPORT PCTreeBatchSolver {
+	unsigned int m_threads;
+	size_t m_chunkSize;
+
+public:
+	/**
+	 * @param threads the number of worker threads, or 0 to use one per hardware thread.
+	 * @param chunkSize the number of instances a worker takes from its own queue at once.
+	 */
+	explicit PCTreeBatchSolver(unsigned int threads = 0, size_t chunkSize = 64);
+
+	unsigned int getThreadCount() const { return m_threads; }
+
+	/**
+	 * Solve all \p instances.
+	 * @param computeOrder whether C1PResult::order should be filled for all solvable instances.
+	 * @return the results in the same order as \p instances.
+	 * @throws std::invalid_argument if an instance refers to a leaf index outside of its leaves
+	 *   or a restriction contains the same leaf twice.
+	 */
+	std::vector<C1PResult> solve(const std::vector<C1PInstance>& instances,
+			bool computeOrder = false) const;
+};
+}
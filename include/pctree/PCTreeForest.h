@@ -33,41 +33,229 @@
 
 #include <pctree/PCEnum.h>
 #include <pctree/PCRegistry.h>
+#include <pctree/PCTreeProfile.h>
 #include <pctree/util/DisjointSets.h>
+#include <pctree/util/EpochArray.h>
 
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <vector>
 
-#define OGDF_PCTREE_REUSE_NODES
+#ifndef PCTREE_UNION_FIND_LINK
+#	define PCTREE_UNION_FIND_LINK Index
+#endif
+#ifndef PCTREE_UNION_FIND_COMPRESSION
+#	define PCTREE_UNION_FIND_COMPRESSION PathSplitting
+#endif
 
 namespace pc_tree {
 using UnionFindIndex = std::size_t;
 
+//! The index type used internally by PCTreeUnionFind.
+#ifdef PCTREE_UNION_FIND_64BIT
+using PCTreeUnionFindIndex = int64_t;
+#else
+using PCTreeUnionFindIndex = int;
+#endif
+
+/**
+ * The union-find structure that maps the C-node parent IDs stored in PCNode%s to the current
+ * C-nodes.
+ *
+ * The policy is chosen at compile time using the CMake options \c PCTREE_UNION_FIND_LINK,
+ * \c PCTREE_UNION_FIND_COMPRESSION and \c PCTREE_UNION_FIND_64BIT, as PCNode::getParent() is
+ * too hot for a dynamic dispatch. Only policies whose links can be reverted by PCTree::rollback()
+ * are supported, i.e., no linking by rank and no collapsing.
+ */
+using PCTreeUnionFind = DisjointSets<LinkOptions::PCTREE_UNION_FIND_LINK,
+		CompressionOptions::PCTREE_UNION_FIND_COMPRESSION, InterleavingOptions::Disabled,
+		PCTreeUnionFindIndex>;
+
 const UnionFindIndex UNIONFINDINDEX_EMPTY = std::numeric_limits<UnionFindIndex>::max();
 
+/**
+ * Temporary information used during each step of the PCTree::makeConsecutive() update operation.
+ * Only non-leaf nodes touched by an update get an instance, which is taken from a pool owned by the
+ * PCTreeForest and recycled once the next update starts.
+ */
+struct OGDF_EXPORT PCNodeTempInfo {
+	PCNode *predPartial = nullptr, *nextPartial = nullptr;
+	PCNode* tpPred = nullptr;
+	PCNode* tpPartialPred = nullptr;
+	size_t tpPartialHeight = 0;
+	PCNode* tpSucc = nullptr;
+	std::vector<PCNode*> fullNeighbors;
+	PCNode *ebEnd1 = nullptr, *fbEnd1 = nullptr, *fbEnd2 = nullptr, *ebEnd2 = nullptr;
+
+	void replaceNeighbor(PCNode* oldNeigh, PCNode* newNeigh) {
+		if (tpPred == oldNeigh) {
+			tpPred = newNeigh;
+		}
+		if (tpPartialPred == oldNeigh) {
+			tpPartialPred = newNeigh;
+		}
+		if (tpSucc == oldNeigh) {
+			tpSucc = newNeigh;
+		}
+		if (ebEnd1 == oldNeigh) {
+			ebEnd1 = newNeigh;
+		}
+		if (ebEnd2 == oldNeigh) {
+			ebEnd2 = newNeigh;
+		}
+		if (fbEnd1 == oldNeigh) {
+			fbEnd1 = newNeigh;
+		}
+		if (fbEnd2 == oldNeigh) {
+			fbEnd2 = newNeigh;
+		}
+	}
+
+	void clear() {
+		nextPartial = predPartial = nullptr;
+		tpPred = tpPartialPred = tpSucc = nullptr;
+		ebEnd1 = fbEnd1 = fbEnd2 = ebEnd2 = nullptr;
+		tpPartialHeight = 0;
+		fullNeighbors.clear();
+	}
+};
+
 /**
  * Multiple PCTrees can be created within the same PCTreeForest, which allows merging the trees later on by making one
  * a child of another. This is extensively used during planarity testing.
+ *
+ * All trees of one forest share its union-find structure, node storage and temporary information, so they may only be
+ * updated by one thread at a time. Different forests share no state at all, so independent trees can be updated in
+ * parallel by giving each thread its own forest. Trees of different forests can still be merged using
+ * PCTree::insertTree(), which then copies the inserted tree into the forest of the target tree.
  * @sa PCTree:insertTree()
  */
 class OGDF_EXPORT PCTreeForest {
 	friend class PCNode;
 	friend class PCTree;
 	friend class PCTreeRegistry;
+	template<bool, bool, typename, typename>
+	friend class FilteringPCTreeWalk;
 
 private:
 	std::vector<PCTree*> m_trees;
 	std::vector<PCNode*> m_cNodes;
-	DisjointSets<> m_parents {1 << 8};
+	PCTreeUnionFind m_parents {1 << 8};
 	int m_nextNodeId = 0;
-	size_t m_timestamp = 0;
+	//! All allocated nodes indexed by their ID, see getNode().
+	std::vector<PCNode*> m_nodesByID;
+	// starts at 1, so that newly created nodes (with timestamp 0) never have valid temporary information
+	size_t m_timestamp = 1;
 	PCTreeRegistry m_nodeArrayRegistry;
 	bool m_autodelete;
+	PCTreeProfile m_profile;
+
+	/**
+	 * A contiguous block of storage for PCNodes.
+	 * The first \c m_used entries have been constructed and are either in use or in the list of reusable nodes.
+	 */
+	struct NodeChunk {
+		PCNode* m_nodes;
+		size_t m_capacity;
+		size_t m_used;
+	};
 
-#ifdef OGDF_PCTREE_REUSE_NODES
+	std::vector<NodeChunk> m_nodeChunks;
+	size_t m_activeChunk = 0;
+	size_t m_liveNodes = 0;
+	//! Destroyed nodes that can be handed out again, linked via PCNode::m_parentPNode.
 	PCNode* m_reusableNodes = nullptr;
-#endif
+	size_t m_reusableNodeCount = 0;
+
+	/**
+	 * An entry of the undo log that is filled while a PCTree of this forest has an active checkpoint.
+	 * Depending on the kind, only some of the fields are used.
+	 * @sa PCTree::checkpoint()
+	 */
+	struct UndoRecord {
+		enum class Kind {
+			NodeState, //!< the structure of #m_node before it was changed
+			NodeCreated, //!< #m_node was newly created
+			NodeDestroyed, //!< #m_node was destroyed, its storage is only released on commit
+			LeafAdded, //!< #m_node was added to the list of leaves
+			LeafRemoved, //!< #m_node was removed from the list of leaves
+			CNodeSlot, //!< the C-node slot #m_index previously contained #m_node
+			Link, //!< the union-find set #m_index was linked into another set
+		};
+
+		Kind m_kind;
+		PCNode* m_node;
+		UnionFindIndex m_index;
+		UnionFindIndex m_parentCNodeId;
+		PCNode* m_parentPNode;
+		PCNode* m_sibling1;
+		PCNode* m_sibling2;
+		PCNode* m_child1;
+		PCNode* m_child2;
+		size_t m_childCount;
+		PCNodeType m_nodeType;
+	};
+
+	//! The state of the recording tree when PCTree::checkpoint() was called.
+	struct UndoCheckpoint {
+		size_t m_logSize;
+		int m_nextNodeId;
+		PCNode* m_rootNode;
+		size_t m_pNodeCount;
+		size_t m_cNodeCount;
+	};
+
+	//! Whether lookups are prevented from modifying shared state, see freeze().
+	bool m_frozen = false;
+
+	//! Incremented on structural changes that are not attributed to a single tree, see
+	//! PCTree::cachedLeafOrder().
+	size_t m_structureVersion = 0;
+	//! The counter incremented by PCNode::recordState(), see PCTree::StructureChange.
+	size_t* m_versionCounter = &m_structureVersion;
+
+	PCTree* m_recordingTree = nullptr;
+	std::vector<UndoRecord> m_undoLog;
+	std::vector<UndoCheckpoint> m_undoCheckpoints;
+
+	//! Pool of temporary information, entries are handed out in order and all released by the next update.
+	std::vector<std::unique_ptr<PCNodeTempInfo[]>> m_tempInfoBlocks;
+	size_t m_tempInfoCount = 0;
+
+	//! Scratch arrays of PCTree::intersect(), which only touches the nodes of the intersected trees.
+	struct IntersectScratch {
+		EpochArray<PCNode*, std::vector<PCNode*>> m_blockNodes;
+		EpochArray<PCNode*, std::vector<PCNode*>> m_subtreeNodes;
+		EpochArray<PCNode*, PCNode*> m_leafPartner {nullptr};
+		EpochArray<PCNode*, bool> m_isFront {false};
+		EpochArray<PCNode*, bool> m_visited {false};
+
+		void clear() {
+			m_blockNodes.clear();
+			m_subtreeNodes.clear();
+			m_leafPartner.clear();
+			m_isFront.clear();
+			m_visited.clear();
+		}
+
+		void release() {
+			m_blockNodes.release();
+			m_subtreeNodes.release();
+			m_leafPartner.release();
+			m_isFront.release();
+			m_visited.release();
+		}
+	};
+
+	IntersectScratch m_intersectScratch;
+
+	//! Buffers for the pending nodes of FilteringPCTreeWalk%s that are currently not in use.
+	//! Never grows beyond its initial capacity, so that returning a buffer doesn't allocate.
+	std::vector<std::unique_ptr<std::vector<PCNode*>>> m_walkBuffers;
+	//! Walks may also be used by concurrent read-only queries, so this is locked while frozen.
+	std::mutex m_walkBuffersMutex;
 
 public:
 	/**
@@ -75,16 +263,143 @@ public:
 	 *   on destruction of this forrest. Note that this does not affect PCTrees directly created by
 	 *   calling PCTree::PCTree(PCTreeForest*).
 	 */
-	PCTreeForest(bool autodelete = true) : m_nodeArrayRegistry(this), m_autodelete(autodelete) {};
+	PCTreeForest(bool autodelete = true) : m_nodeArrayRegistry(this), m_autodelete(autodelete) {
+		m_walkBuffers.reserve(WALK_BUFFER_POOL_SIZE);
+	};
 
 	virtual ~PCTreeForest();
 
 	//! Create a new tree that may be automatically deleted when this forest is deleted.
 	PCTree* makeTree(void);
 
-	//! Delete all trees created by makeTree().
+	/**
+	 * Delete all trees created by makeTree().
+	 * Other trees of this forest, including those created by makeTree() if autodelete is \c false,
+	 * keep their nodes, but can't be used anymore as the state of the forest is reset.
+	 * If afterwards no nodes are alive anymore, the node storage is reset in time linear in the number of chunks
+	 * and will be reused by later trees, but it is only freed once this forest is deleted.
+	 */
 	void clear(void);
 
+	/**
+	 * Make sure that the next \p count new nodes can be created without further memory allocations.
+	 * When a chunk needs to be allocated for this, all \p count nodes will be stored contiguously.
+	 */
+	void reserveNodes(size_t count);
+
+	//! The number of nodes the allocated storage of this forest can hold, including the live ones.
+	size_t getNodeCapacity() const {
+		size_t capacity = 0;
+		for (const NodeChunk& chunk : m_nodeChunks) {
+			capacity += chunk.m_capacity;
+		}
+		return capacity;
+	}
+
+	/**
+	 * Renumber all live nodes of this forest densely and drop the space of destroyed nodes.
+	 *
+	 * Node IDs are never reused and C-nodes that are merged or destroyed leave their union-find slot
+	 * behind, so forests with a lot of churn grow steadily. This assigns the IDs 0..n-1 to the n live
+	 * nodes (keeping their relative order), rebuilds the union-find structure over the live C-nodes
+	 * and shrinks all registered PCTreeNodeArray%s, whose entries move along with their nodes.
+	 * Runs in time linear in the number of IDs handed out since the last compaction.
+	 *
+	 * Afterwards, PCNode::index() of most nodes changes, so IDs stored outside of PCTreeNodeArray%s
+	 * can no longer be used, e.g. with getNode(). Counts as a structural change to all trees, so
+	 * their PCTree::cachedLeafOrder() is recomputed. PCNode::getLeafIndex() is not changed, so
+	 * leaf indices stay valid.
+	 * @pre No tree of this forest has an active checkpoint and the forest is not frozen.
+	 * @pre No nodes are alive that were created before the last call to clear().
+	 */
+	void compact();
+
+	/**
+	 * Prepare the trees of this forest for concurrent read-only access.
+	 * Compresses the union-find structure of all C-nodes, after which PCNode::getParent() no longer updates it
+	 * or the cached parent of the node. Thus, read-only queries like PCTree::currentLeafOrder(),
+	 * PCTree::possibleOrders(), PCTree::uniqueID() or PCTree::isValidOrder() can be run on multiple threads
+	 * simultaneously. No tree of this forest may be modified until unfreeze() is called.
+	 * @pre No tree of this forest has an active checkpoint.
+	 */
+	void freeze();
+
+	//! Allow modifications of the trees in this forest again, see freeze().
+	void unfreeze() {
+		m_frozen = false;
+		m_nodeArrayRegistry.setConcurrent(false);
+	}
+
+	bool isFrozen() const { return m_frozen; }
+
+	/**
+	 * Look up a node of any tree in this forest by its PCNode::index().
+	 * Nodes that were destroyed while a checkpoint is active can still be found until PCTree::commit().
+	 * @return the node with the given ID or \c nullptr if there is none.
+	 */
+	PCNode* getNode(size_t id) const { return id < m_nodesByID.size() ? m_nodesByID[id] : nullptr; }
+
 	operator const PCTreeRegistry&() const { return m_nodeArrayRegistry; }
+
+	//! Phase timings accumulated by all trees of this forest, also across clear().
+	const PCTreeProfile& getProfile() const { return m_profile; }
+
+	void resetProfile() { m_profile.reset(); }
+
+private:
+	PCNode* allocateNode(size_t id, PCNodeType type);
+
+	void releaseNode(PCNode* node);
+
+	std::vector<PCNode*>* acquireWalkBuffer();
+
+	//! Return \p buffer to the pool, or free it if the pool is full or the buffer is too large.
+	void releaseWalkBuffer(std::vector<PCNode*>* buffer) noexcept;
+
+	//! Make getNode() return \p node for its current ID.
+	void setNodeID(PCNode* node);
+
+	//! Make sure that \p tree, which is about to be deleted, won't be deleted again by clear().
+	void releaseTree(PCTree* tree);
+
+	void resetNodeStorage();
+
+	PCNodeTempInfo* newTempInfo() {
+		size_t block = m_tempInfoCount / TEMP_INFO_BLOCK_SIZE;
+		if (block == m_tempInfoBlocks.size()) {
+			m_tempInfoBlocks.emplace_back(new PCNodeTempInfo[TEMP_INFO_BLOCK_SIZE]);
+		}
+		PCNodeTempInfo* info = &m_tempInfoBlocks[block][m_tempInfoCount % TEMP_INFO_BLOCK_SIZE];
+		m_tempInfoCount++;
+		info->clear();
+		return info;
+	}
+
+	void releaseTempInfos() { m_tempInfoCount = 0; }
+
+	bool isRecording() const { return m_recordingTree != nullptr; }
+
+	void recordNodeState(PCNode* node);
+
+	void recordUndo(UndoRecord::Kind kind, PCNode* node, UnionFindIndex index = UNIONFINDINDEX_EMPTY) {
+		OGDF_ASSERT(isRecording());
+		UndoRecord& record = m_undoLog.emplace_back();
+		record.m_kind = kind;
+		record.m_node = node;
+		record.m_index = index;
+	}
+
+	//! Find the representative of a C-node set, without path compression while undo information is recorded or while frozen.
+	UnionFindIndex findCNodeSet(UnionFindIndex id) {
+		if (isRecording() || m_frozen) {
+			return m_parents.getRepresentative(id);
+		}
+		return m_parents.find(id);
+	}
+
+	static constexpr size_t TEMP_INFO_BLOCK_SIZE = 1 << 8;
+	static constexpr size_t WALK_BUFFER_POOL_SIZE = 1 << 4;
+	//! The largest capacity of a buffer that is kept for the next walk.
+	static constexpr size_t WALK_BUFFER_MAX_CAPACITY = 1 << 16;
 };
 }
@@ -35,9 +35,10 @@
 #include <pctree/PCNode.h>
 
 #include <algorithm>
-#include <deque>
 #include <functional>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace pc_tree {
 class OGDF_EXPORT PCNodeIterator {
@@ -117,18 +118,40 @@ struct OGDF_EXPORT PCNodeNeighborsIterable {
 	unsigned long count() const;
 };
 
+//! Filter for FilteringPCTreeWalk that accepts all nodes.
+struct AllPCNodes {
+	bool operator()([[maybe_unused]] PCNode* node) const { return true; }
+};
+
+//! Filter for FilteringPCTreeWalk that only accepts inner nodes, see PCTree::innerNodes().
+struct InnerPCNodes {
+	bool operator()(PCNode* node) const { return !node->isLeaf(); }
+};
+
 /**
  * A DFS or BFS through a PCTree.
+ * The filters \p Visit and \p Descend are called for each node to decide whether it should be visited and
+ * whether its children should be walked, respectively. Pass concrete types like AllPCNodes or a lambda type
+ * so that the calls can be inlined, as opposed to the std::function used by FilteringPCTreeDFS and
+ * FilteringPCTreeBFS.
+ *
+ * The pending nodes are stored in a buffer borrowed from the forest of the start node, which is returned
+ * once the walk is destructed, so that repeated walks don't need to allocate memory. Thus, a walk may not
+ * outlive its forest.
  * @sa FilteringBFS
  */
-template<bool dfs, bool reverse = false>
+template<bool dfs, bool reverse = false, typename Visit = std::function<bool(PCNode*)>,
+		typename Descend = Visit>
 class FilteringPCTreeWalk {
-	using container_type =
-			typename std::conditional<dfs, std::vector<PCNode*>, std::deque<PCNode*>>::type;
+	template<bool, bool, typename, typename>
+	friend class FilteringPCTreeWalk;
 
-	container_type m_pending;
-	std::function<bool(PCNode*)> m_visit;
-	std::function<bool(PCNode*)> m_descend;
+	PCTreeForest* m_forest = nullptr;
+	std::vector<PCNode*>* m_pending = nullptr;
+	//! For a BFS, the index of the first pending node in #m_pending, all nodes before it were already visited.
+	size_t m_head = 0;
+	Visit m_visit;
+	Descend m_descend;
 
 public:
 	// iterator traits
@@ -143,28 +166,75 @@ public:
 	explicit FilteringPCTreeWalk() = default;
 
 	explicit FilteringPCTreeWalk([[maybe_unused]] const PCTree& T, PCNode* start,
-			std::function<bool(PCNode*)> visit = return_true,
-			std::function<bool(PCNode*)> descend_from = return_true)
-		: m_pending({start}), m_visit(std::move(visit)), m_descend(std::move(descend_from)) {
-		if (!m_pending.empty() && !m_visit(top())) {
-			next();
+			Visit visit = defaultFilter<Visit>(), Descend descend_from = defaultFilter<Descend>())
+		: m_visit(std::move(visit)), m_descend(std::move(descend_from)) {
+		if (start != nullptr) {
+			append(start);
+			if (!m_visit(top())) {
+				next();
+			}
+		}
+	}
+
+	FilteringPCTreeWalk(const FilteringPCTreeWalk& other)
+		: m_visit(other.m_visit), m_descend(other.m_descend) {
+		copyPending(other);
+	}
+
+	FilteringPCTreeWalk(FilteringPCTreeWalk&& other) noexcept
+		: m_visit(std::move(other.m_visit)), m_descend(std::move(other.m_descend)) {
+		stealPending(other);
+	}
+
+	//! Convert a walk with different filter types, e.g. to a FilteringPCTreeDFS.
+	template<typename OtherVisit, typename OtherDescend>
+	FilteringPCTreeWalk(const FilteringPCTreeWalk<dfs, reverse, OtherVisit, OtherDescend>& other)
+		: m_visit(other.m_visit), m_descend(other.m_descend) {
+		copyPending(other);
+	}
+
+	template<typename OtherVisit, typename OtherDescend>
+	FilteringPCTreeWalk(FilteringPCTreeWalk<dfs, reverse, OtherVisit, OtherDescend>&& other)
+		: m_visit(std::move(other.m_visit)), m_descend(std::move(other.m_descend)) {
+		stealPending(other);
+	}
+
+	FilteringPCTreeWalk& operator=(FilteringPCTreeWalk other) noexcept {
+		std::swap(m_forest, other.m_forest);
+		std::swap(m_pending, other.m_pending);
+		std::swap(m_head, other.m_head);
+		std::swap(m_visit, other.m_visit);
+		std::swap(m_descend, other.m_descend);
+		return *this;
+	}
+
+	~FilteringPCTreeWalk() {
+		if (m_pending != nullptr) {
+			m_forest->releaseWalkBuffer(m_pending);
 		}
 	}
 
-	bool operator==(const FilteringPCTreeWalk& rhs) const { return m_pending == rhs.m_pending; }
+	bool operator==(const FilteringPCTreeWalk& rhs) const {
+		if (pendingCount() != rhs.pendingCount()) {
+			return false;
+		}
+		return pendingCount() == 0
+				|| std::equal(m_pending->begin() + m_head, m_pending->end(),
+						rhs.m_pending->begin() + rhs.m_head);
+	}
 
-	bool operator!=(const FilteringPCTreeWalk& rhs) const { return m_pending != rhs.m_pending; }
+	bool operator!=(const FilteringPCTreeWalk& rhs) const { return !(*this == rhs); }
 
 	FilteringPCTreeWalk& begin() { return *this; }
 
 	FilteringPCTreeWalk end() const { return FilteringPCTreeWalk(); }
 
 	PCNode* top() {
-		OGDF_ASSERT(!m_pending.empty());
+		OGDF_ASSERT(valid());
 		if constexpr (dfs) {
-			return m_pending.back();
+			return m_pending->back();
 		} else {
-			return m_pending.front();
+			return (*m_pending)[m_head];
 		}
 	}
 
@@ -187,30 +257,66 @@ public:
 
 	void next() {
 		do {
-			OGDF_ASSERT(!m_pending.empty());
+			OGDF_ASSERT(valid());
 			PCNode* node = top();
 			if constexpr (dfs) {
-				m_pending.pop_back();
+				m_pending->pop_back();
 			} else {
-				m_pending.pop_front();
+				m_head++;
 			}
 			if (m_descend(node)) {
-				std::copy(node->children().begin(), node->children().end(),
-						std::back_inserter(m_pending));
+				for (PCNode* child : node->children()) {
+					m_pending->push_back(child);
+				}
 				if constexpr (reverse) {
-					std::reverse(m_pending.end() - node->getChildCount(), m_pending.end());
+					std::reverse(m_pending->end() - node->getChildCount(), m_pending->end());
 				}
 			}
-		} while (!m_pending.empty() && !m_visit(top()));
+		} while (valid() && !m_visit(top()));
 	}
 
 	explicit operator bool() const { return valid(); }
 
-	bool valid() const { return !m_pending.empty(); }
+	bool valid() const { return pendingCount() > 0; }
+
+	void append(PCNode* a) {
+		if (m_pending == nullptr) {
+			m_forest = a->getForest();
+			m_pending = m_forest->acquireWalkBuffer();
+		}
+		m_pending->push_back(a);
+	}
 
-	void append(PCNode* a) { m_pending.push(a); }
+	int pendingCount() const { return m_pending == nullptr ? 0 : m_pending->size() - m_head; }
 
-	int pendingCount() const { return m_pending.size(); }
+private:
+	template<typename Filter>
+	static Filter defaultFilter() {
+		if constexpr (std::is_constructible_v<Filter, bool (*)(PCNode*)>) {
+			return Filter(return_true);
+		} else {
+			return Filter();
+		}
+	}
+
+	template<typename Other>
+	void copyPending(const Other& other) {
+		if (other.valid()) {
+			m_forest = other.m_forest;
+			m_pending = m_forest->acquireWalkBuffer();
+			m_pending->assign(other.m_pending->begin() + other.m_head, other.m_pending->end());
+		}
+	}
+
+	template<typename Other>
+	void stealPending(Other& other) {
+		m_forest = other.m_forest;
+		m_pending = other.m_pending;
+		m_head = other.m_head;
+		other.m_forest = nullptr;
+		other.m_pending = nullptr;
+		other.m_head = 0;
+	}
 };
 
 using FilteringPCTreeDFS = FilteringPCTreeWalk<true>;
@@ -0,0 +1,116 @@
+/** \file
+ * \brief Built-in per-phase timing of PCTree updates.
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#pragma once
+
+#include <pctree/util/defines.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * When defined, the phases of PCTree::makeConsecutive() are timed and the results are accumulated in the
+ * PCTreeProfile of the respective PCTreeForest.
+ * The CMake build defines this for the PCTree target and all its consumers if the option \c PCTREE_PROFILE is set.
+ */
+#ifdef PCTREE_PROFILE
+#	define PCTREE_PROFILE_BEGIN(phase) \
+		const ::pc_tree::PCTreeProfile::Clock::time_point pctree_profile_start_##phase = \
+				::pc_tree::PCTreeProfile::Clock::now()
+#	define PCTREE_PROFILE_END(phase) \
+		m_forest->m_profile.record(::pc_tree::PCTreeProfile::Phase::phase, pctree_profile_start_##phase)
+#else
+#	define PCTREE_PROFILE_BEGIN(phase)
+#	define PCTREE_PROFILE_END(phase)
+#endif
+
+namespace pc_tree {
+/**
+ * Accumulated running times and call counts of the individual phases of PCTree::makeConsecutive(),
+ * as recorded for all trees of a PCTreeForest.
+ * Only collected if the library was compiled with \c PCTREE_PROFILE, otherwise all values stay zero.
+ * @sa PCTreeForest::getProfile()
+ */
+class OGDF_EXPORT PCTreeProfile {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Phase {
+		MarkFull, //!< labeling of full and partial nodes, see PCTree::markFull()
+		FindTerminalPath, //!< search for the terminal path, see PCTree::findTerminalPath()
+		CreateCentralNode, //!< creation of the central C-node, see PCTree::createCentralNode()
+		UpdateTerminalPath, //!< merging of the terminal path into the central node, see PCTree::updateTerminalPath()
+	};
+
+	static constexpr size_t PhaseCount = 4;
+
+#ifdef PCTREE_PROFILE
+	static constexpr bool enabled = true;
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	struct Counter {
+		uint64_t calls = 0;
+		Clock::duration time = Clock::duration::zero();
+	};
+
+	//! Add one execution of \p phase that started at \p start and ends now.
+	void record(Phase phase, Clock::time_point start) {
+		Counter& counter = m_counters[static_cast<size_t>(phase)];
+		counter.time += Clock::now() - start;
+		counter.calls++;
+	}
+
+	const Counter& operator[](Phase phase) const { return m_counters[static_cast<size_t>(phase)]; }
+
+	//! Summed up time of all phases.
+	Clock::duration totalTime() const {
+		Clock::duration sum = Clock::duration::zero();
+		for (const Counter& counter : m_counters) {
+			sum += counter.time;
+		}
+		return sum;
+	}
+
+	void reset() { m_counters.fill(Counter {}); }
+
+private:
+	std::array<Counter, PhaseCount> m_counters;
+};
+
+OGDF_EXPORT std::ostream& operator<<(std::ostream&, PCTreeProfile::Phase);
+
+//! Prints one line with the call count and total time in microseconds per phase.
+OGDF_EXPORT std::ostream& operator<<(std::ostream&, const PCTreeProfile&);
+}
@@ -35,6 +35,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 namespace pc_tree {
 
@@ -84,10 +85,17 @@ struct InterleavingOption : AnyOption { };
 }
 
 //! A Union/Find data structure for maintaining disjoint sets.
+/**
+ * @tparam IndexType The signed integer type used for set ids, e.g. \c int64_t for more than
+ *   2^31 elements.
+ */
 template<LinkOptions linkOption = LinkOptions::Index,
 		CompressionOptions compressionOption = CompressionOptions::PathSplitting,
-		InterleavingOptions interleavingOption = InterleavingOptions::Disabled>
+		InterleavingOptions interleavingOption = InterleavingOptions::Disabled,
+		typename IndexType = int>
 class DisjointSets {
+	static_assert(std::is_integral<IndexType>::value && std::is_signed<IndexType>::value,
+			"Set ids must be signed integers.");
 	static_assert(interleavingOption != InterleavingOptions::Rem || linkOption == LinkOptions::Index,
 			"Rem's Algorithm requires linking by index.");
 	static_assert(interleavingOption != InterleavingOptions::Tarjan || linkOption == LinkOptions::Rank,
@@ -100,50 +108,58 @@ class DisjointSets {
 			"Interleaved Path Splitting Path Compression requires linking by index.");
 
 private:
-	int m_numberOfSets; //!< Current number of disjoint sets.
-	int m_numberOfElements; //!< Current number of elements.
-	int m_maxNumberOfElements; //!< Maximum number of elements (array size) adjusted dynamically.
+	IndexType m_numberOfSets; //!< Current number of disjoint sets.
+	IndexType m_numberOfElements; //!< Current number of elements.
+	//! Maximum number of elements (array size) adjusted dynamically.
+	IndexType m_maxNumberOfElements;
 
 	// Arrays parents, elements, parameters, siblings map a set id to its properties.
 
-	int* m_parents; //!< Maps set id to parent set id.
-	int* m_parameters; //!< Maps set id to rank/size.
-	int* m_siblings; //!< Maps set id to sibling set id.
+	IndexType* m_parents; //!< Maps set id to parent set id.
+	IndexType* m_parameters; //!< Maps set id to rank/size.
+	IndexType* m_siblings; //!< Maps set id to sibling set id.
 
 	//find
-	int find(disjoint_sets::CompressionOption<CompressionOptions::PathCompression>, int set);
-	int find(disjoint_sets::CompressionOption<CompressionOptions::PathSplitting>, int set);
-	int find(disjoint_sets::CompressionOption<CompressionOptions::PathHalving>, int set);
-	int find(disjoint_sets::CompressionOption<CompressionOptions::Type1Reversal>, int set);
-	int find(disjoint_sets::CompressionOption<CompressionOptions::Collapsing>, int set);
-	int find(disjoint_sets::CompressionOption<CompressionOptions::Disabled>, int set);
+	IndexType find(disjoint_sets::CompressionOption<CompressionOptions::PathCompression>,
+			IndexType set);
+	IndexType find(disjoint_sets::CompressionOption<CompressionOptions::PathSplitting>,
+			IndexType set);
+	IndexType find(disjoint_sets::CompressionOption<CompressionOptions::PathHalving>,
+			IndexType set);
+	IndexType find(disjoint_sets::CompressionOption<CompressionOptions::Type1Reversal>,
+			IndexType set);
+	IndexType find(disjoint_sets::CompressionOption<CompressionOptions::Collapsing>, IndexType set);
+	IndexType find(disjoint_sets::CompressionOption<CompressionOptions::Disabled>, IndexType set);
 
 	//link
-	int link(disjoint_sets::LinkOption<LinkOptions::Naive>, int set1, int set2);
-	int link(disjoint_sets::LinkOption<LinkOptions::Index>, int set1, int set2);
-	int link(disjoint_sets::LinkOption<LinkOptions::Size>, int set1, int set2);
-	int link(disjoint_sets::LinkOption<LinkOptions::Rank>, int set1, int set2);
+	IndexType link(disjoint_sets::LinkOption<LinkOptions::Naive>, IndexType set1, IndexType set2);
+	IndexType link(disjoint_sets::LinkOption<LinkOptions::Index>, IndexType set1, IndexType set2);
+	IndexType link(disjoint_sets::LinkOption<LinkOptions::Size>, IndexType set1, IndexType set2);
+	IndexType link(disjoint_sets::LinkOption<LinkOptions::Rank>, IndexType set1, IndexType set2);
 
 	//quickUnion
 	bool quickUnion(disjoint_sets::LinkOption<LinkOptions::Index>,
-			disjoint_sets::InterleavingOption<InterleavingOptions::Rem>, int set1, int set2);
+			disjoint_sets::InterleavingOption<InterleavingOptions::Rem>, IndexType set1,
+			IndexType set2);
 	bool quickUnion(disjoint_sets::LinkOption<LinkOptions::Index>,
-			disjoint_sets::InterleavingOption<InterleavingOptions::SplittingCompression>, int set1,
-			int set2);
+			disjoint_sets::InterleavingOption<InterleavingOptions::SplittingCompression>,
+			IndexType set1, IndexType set2);
 	bool quickUnion(disjoint_sets::LinkOption<LinkOptions::Rank>,
-			disjoint_sets::InterleavingOption<InterleavingOptions::Tarjan>, int set1, int set2);
+			disjoint_sets::InterleavingOption<InterleavingOptions::Tarjan>, IndexType set1,
+			IndexType set2);
 	bool quickUnion(disjoint_sets::AnyOption,
-			disjoint_sets::InterleavingOption<InterleavingOptions::Disabled>, int set1, int set2);
+			disjoint_sets::InterleavingOption<InterleavingOptions::Disabled>, IndexType set1,
+			IndexType set2);
 	bool quickUnion(disjoint_sets::LinkOption<LinkOptions::Naive>,
-			disjoint_sets::InterleavingOption<InterleavingOptions::Type0Reversal>, int set1,
-			int set2);
+			disjoint_sets::InterleavingOption<InterleavingOptions::Type0Reversal>, IndexType set1,
+			IndexType set2);
 
 public:
 	//! Creates an empty DisjointSets structure.
 	/**
 	 * \param maxNumberOfElements Expected number of Elements.
 	 */
-	explicit DisjointSets(int maxNumberOfElements = (1 << 15))
+	explicit DisjointSets(IndexType maxNumberOfElements = (1 << 15))
 		: m_parents(nullptr), m_parameters(nullptr), m_siblings(nullptr) {
 		init(maxNumberOfElements);
 	}
@@ -180,7 +196,7 @@ public:
 	OGDF_COPY_MOVE_BY_SWAP(DisjointSets)
 
 	//! Resets the DisjointSets structure to be empty, also changing the expected number of elements.
-	void init(int maxNumberOfElements) {
+	void init(IndexType maxNumberOfElements) {
 		this->m_maxNumberOfElements = maxNumberOfElements;
 		init();
 	}
@@ -192,12 +208,12 @@ public:
 		delete[] this->m_siblings;
 		this->m_numberOfSets = 0;
 		this->m_numberOfElements = 0;
-		this->m_parents = new int[this->m_maxNumberOfElements];
+		this->m_parents = new IndexType[this->m_maxNumberOfElements];
 		this->m_parameters = (linkOption == LinkOptions::Rank || linkOption == LinkOptions::Size)
-				? new int[this->m_maxNumberOfElements]
+				? new IndexType[this->m_maxNumberOfElements]
 				: nullptr;
 		this->m_siblings = (compressionOption == CompressionOptions::Collapsing)
-				? new int[this->m_maxNumberOfElements]
+				? new IndexType[this->m_maxNumberOfElements]
 				: nullptr;
 	}
 
@@ -207,7 +223,7 @@ public:
 	 * \return Superset id
 	 * \pre \p set is a non negative properly initialized id.
 	 */
-	int find(int set) {
+	IndexType find(IndexType set) {
 		OGDF_ASSERT(set >= 0);
 		OGDF_ASSERT(set < m_numberOfElements);
 		return find(disjoint_sets::CompressionOption<compressionOption>(), set);
@@ -219,7 +235,7 @@ public:
 	 * \return Superset id
 	 * \pre \p set is a non negative properly initialized id.
 	 */
-	int getRepresentative(int set) const {
+	IndexType getRepresentative(IndexType set) const {
 		OGDF_ASSERT(set >= 0);
 		OGDF_ASSERT(set < m_numberOfElements);
 		while (set != m_parents[set]) {
@@ -228,34 +244,51 @@ public:
 		return set;
 	}
 
+	//! Compresses all paths, so that afterwards every set directly points to its largest superset.
+	/**
+	 * Afterwards, getRepresentative() needs at most one step for every set.
+	 */
+	void compressAll() {
+		for (IndexType set = 0; set < m_numberOfElements; set++) {
+			IndexType root = getRepresentative(set);
+			IndexType curr = set;
+			while (m_parents[curr] != root) {
+				IndexType next = m_parents[curr];
+				m_parents[curr] = root;
+				curr = next;
+			}
+		}
+	}
+
 	//! Initializes a singleton set.
 	/**
 	 * \return Set id of the initialized singleton set.
 	 */
-	int makeSet() {
+	IndexType makeSet() {
 		if (this->m_numberOfElements == this->m_maxNumberOfElements) {
-			int* parents = this->m_parents;
-			this->m_parents = new int[this->m_maxNumberOfElements * 2];
-			memcpy(this->m_parents, parents, sizeof(int) * this->m_maxNumberOfElements);
+			IndexType* parents = this->m_parents;
+			this->m_parents = new IndexType[this->m_maxNumberOfElements * 2];
+			memcpy(this->m_parents, parents, sizeof(IndexType) * this->m_maxNumberOfElements);
 			delete[] parents;
 
 			if (this->m_parameters != nullptr) {
-				int* parameters = this->m_parameters;
-				this->m_parameters = new int[this->m_maxNumberOfElements * 2];
-				memcpy(this->m_parameters, parameters, sizeof(int) * this->m_maxNumberOfElements);
+				IndexType* parameters = this->m_parameters;
+				this->m_parameters = new IndexType[this->m_maxNumberOfElements * 2];
+				memcpy(this->m_parameters, parameters,
+						sizeof(IndexType) * this->m_maxNumberOfElements);
 				delete[] parameters;
 			}
 
 			if (this->m_siblings != nullptr) {
-				int* siblings = this->m_siblings;
-				this->m_siblings = new int[this->m_maxNumberOfElements * 2];
-				memcpy(this->m_siblings, siblings, sizeof(int) * this->m_maxNumberOfElements);
+				IndexType* siblings = this->m_siblings;
+				this->m_siblings = new IndexType[this->m_maxNumberOfElements * 2];
+				memcpy(this->m_siblings, siblings, sizeof(IndexType) * this->m_maxNumberOfElements);
 				delete[] siblings;
 			}
 			this->m_maxNumberOfElements *= 2;
 		}
 		this->m_numberOfSets++;
-		int id = this->m_numberOfElements++;
+		IndexType id = this->m_numberOfElements++;
 		this->m_parents[id] = id;
 		//Initialize size/ rank/ sibling.
 		if (linkOption == LinkOptions::Size) {
@@ -274,7 +307,7 @@ public:
 	 * \pre \p set1 and \p set2 are maximal disjoint sets.
 	 * \return Set id of the union.
 	 */
-	int link(int set1, int set2) {
+	IndexType link(IndexType set1, IndexType set2) {
 		OGDF_ASSERT(set1 == getRepresentative(set1));
 		OGDF_ASSERT(set2 == getRepresentative(set2));
 		if (set1 == set2) {
@@ -284,11 +317,33 @@ public:
 		return linkPure(set1, set2);
 	}
 
+	//! Reverts the call to link() that made \p set a subset of another set.
+	/**
+	 * \pre \p set was returned by makeSet() or link() and its parent is the set it was linked into.
+	 *      No path containing \p set was compressed since that call to link() and all later calls
+	 *      to link() were already reverted.
+	 */
+	void unlink(IndexType set) {
+		static_assert(linkOption != LinkOptions::Rank,
+				"Reverting link() is not possible with linking by rank.");
+		static_assert(compressionOption != CompressionOptions::Collapsing,
+				"Reverting link() is not possible with collapsing.");
+		OGDF_ASSERT(set >= 0);
+		OGDF_ASSERT(set < m_numberOfElements);
+		OGDF_ASSERT(set != m_parents[set]);
+		OGDF_ASSERT(m_parents[set] == m_parents[m_parents[set]]);
+		if (linkOption == LinkOptions::Size) {
+			this->m_parameters[this->m_parents[set]] -= this->m_parameters[set];
+		}
+		this->m_parents[set] = set;
+		this->m_numberOfSets++;
+	}
+
 	//! Unions the maximal disjoint sets containing \p set1 and \p set2.
 	/**
 	 * \return True, if the maximal sets containing \p set1 and \p set2 were disjoint und joined correctly. False otherwise.
 	 */
-	bool quickUnion(int set1, int set2) {
+	bool quickUnion(IndexType set1, IndexType set2) {
 		if (set1 == set2) {
 			return false;
 		}
@@ -299,10 +354,10 @@ public:
 	}
 
 	//! Returns the current number of disjoint sets.
-	int getNumberOfSets() { return m_numberOfSets; }
+	IndexType getNumberOfSets() { return m_numberOfSets; }
 
 	//! Returns the current number of elements.
-	int getNumberOfElements() { return m_numberOfElements; }
+	IndexType getNumberOfElements() { return m_numberOfElements; }
 
 private:
 	//! Unions \p set1 and \p set2 w/o decreasing the \a numberOfSets
@@ -310,12 +365,12 @@ private:
 	 * \pre \p set1 and \p set2 are maximal disjoint sets.
 	 * \return Set id of the union
 	 */
-	int linkPure(int set1, int set2) {
-		int superset = link(disjoint_sets::LinkOption<linkOption>(), set1, set2);
+	IndexType linkPure(IndexType set1, IndexType set2) {
+		IndexType superset = link(disjoint_sets::LinkOption<linkOption>(), set1, set2);
 		//Collapse subset tree.
 		if (compressionOption == CompressionOptions::Collapsing) {
-			int subset = set1 == superset ? set2 : set1;
-			int id = subset;
+			IndexType subset = set1 == superset ? set2 : set1;
+			IndexType id = subset;
 			while (this->m_siblings[id] != -1) {
 				id = this->m_siblings[id];
 				this->m_parents[id] = superset;
@@ -328,10 +383,11 @@ private:
 };
 
 //find
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
-		disjoint_sets::CompressionOption<CompressionOptions::PathCompression>, int set) {
-	int parent = m_parents[set];
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::find(
+		disjoint_sets::CompressionOption<CompressionOptions::PathCompression>, IndexType set) {
+	IndexType parent = m_parents[set];
 	if (set == parent) {
 		return set;
 	} else {
@@ -342,23 +398,25 @@ int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
 	}
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
-		disjoint_sets::CompressionOption<CompressionOptions::PathHalving>, int set) {
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::find(
+		disjoint_sets::CompressionOption<CompressionOptions::PathHalving>, IndexType set) {
 	while (set != m_parents[set]) {
-		int parent = m_parents[set];
-		int grandParent = m_parents[parent];
+		IndexType parent = m_parents[set];
+		IndexType grandParent = m_parents[parent];
 		m_parents[set] = grandParent;
 		set = grandParent;
 	}
 	return set;
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
-		disjoint_sets::CompressionOption<CompressionOptions::PathSplitting>, int set) {
-	int parent = m_parents[set];
-	int grandParent = m_parents[parent];
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::find(
+		disjoint_sets::CompressionOption<CompressionOptions::PathSplitting>, IndexType set) {
+	IndexType parent = m_parents[set];
+	IndexType grandParent = m_parents[parent];
 	while (parent != grandParent) {
 		m_parents[set] = grandParent;
 		set = parent;
@@ -368,14 +426,15 @@ int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
 	return parent;
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
-		disjoint_sets::CompressionOption<CompressionOptions::Type1Reversal>, int set) {
-	int root = set;
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::find(
+		disjoint_sets::CompressionOption<CompressionOptions::Type1Reversal>, IndexType set) {
+	IndexType root = set;
 	set = m_parents[root];
 
 	while (set != m_parents[set]) {
-		int parent = m_parents[set];
+		IndexType parent = m_parents[set];
 		m_parents[set] = root;
 		set = parent;
 	}
@@ -383,26 +442,29 @@ int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
 	return set;
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
-		disjoint_sets::CompressionOption<CompressionOptions::Disabled>, int set) {
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::find(
+		disjoint_sets::CompressionOption<CompressionOptions::Disabled>, IndexType set) {
 	while (set != m_parents[set]) {
 		set = m_parents[set];
 	}
 	return set;
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::find(
-		disjoint_sets::CompressionOption<CompressionOptions::Collapsing>, int set) {
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::find(
+		disjoint_sets::CompressionOption<CompressionOptions::Collapsing>, IndexType set) {
 	return m_parents[set];
 }
 
 //quickUnion
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion(
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+bool DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::quickUnion(
 		disjoint_sets::AnyOption, disjoint_sets::InterleavingOption<InterleavingOptions::Disabled>,
-		int set1, int set2) {
+		IndexType set1, IndexType set2) {
 #ifdef OGDF_DISJOINT_SETS_INTERMEDIATE_PARENT_CHECK
 	if (m_parents[set1] == m_parents[set2]) {
 		return false;
@@ -417,18 +479,20 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 	return false;
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion(
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+bool DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::quickUnion(
 		disjoint_sets::LinkOption<LinkOptions::Naive>,
-		disjoint_sets::InterleavingOption<InterleavingOptions::Type0Reversal>, int set1, int set2) {
+		disjoint_sets::InterleavingOption<InterleavingOptions::Type0Reversal>, IndexType set1,
+		IndexType set2) {
 #ifdef OGDF_DISJOINT_SETS_INTERMEDIATE_PARENT_CHECK
 	if (m_parents[set1] == m_parents[set2]) {
 		return false;
 	}
 #endif
-	int root = set2;
-	int set = set2;
-	int parent = m_parents[set];
+	IndexType root = set2;
+	IndexType set = set2;
+	IndexType parent = m_parents[set];
 	m_parents[set] = root;
 	while (set != parent) {
 		if (parent == set1) {
@@ -455,14 +519,16 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 	}
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion(
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+bool DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::quickUnion(
 		disjoint_sets::LinkOption<LinkOptions::Index>,
-		disjoint_sets::InterleavingOption<InterleavingOptions::Rem>, int set1, int set2) {
-	int r_x = set1;
-	int r_y = set2;
-	int p_r_x = m_parents[r_x];
-	int p_r_y = m_parents[r_y];
+		disjoint_sets::InterleavingOption<InterleavingOptions::Rem>, IndexType set1,
+		IndexType set2) {
+	IndexType r_x = set1;
+	IndexType r_y = set2;
+	IndexType p_r_x = m_parents[r_x];
+	IndexType p_r_y = m_parents[r_y];
 	while (p_r_x != p_r_y) {
 		if (p_r_x < p_r_y) {
 			if (r_x == p_r_x) {
@@ -485,17 +551,18 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 	return false;
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion(
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+bool DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::quickUnion(
 		disjoint_sets::LinkOption<LinkOptions::Index>,
-		disjoint_sets::InterleavingOption<InterleavingOptions::SplittingCompression>, int set1,
-		int set2) {
+		disjoint_sets::InterleavingOption<InterleavingOptions::SplittingCompression>,
+		IndexType set1, IndexType set2) {
 #ifdef OGDF_DISJOINT_SETS_INTERMEDIATE_PARENT_CHECK
 	if (m_parents[set1] == m_parents[set2]) {
 		return false;
 	}
 #endif
-	int set = set1;
+	IndexType set = set1;
 
 	if (set1 < set2) {
 		set = set2;
@@ -505,8 +572,8 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 
 	//!Use path splitting to compress the path of set1 and get the root
 	set = m_parents[set];
-	int parent = m_parents[set];
-	int grandParent = m_parents[parent];
+	IndexType parent = m_parents[set];
+	IndexType grandParent = m_parents[parent];
 	while (parent != grandParent) {
 		m_parents[set] = grandParent;
 		set = parent;
@@ -514,7 +581,7 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 		grandParent = m_parents[grandParent];
 	}
 	m_parents[set1] = parent;
-	int root = parent;
+	IndexType root = parent;
 
 	//!Redirect all nodes with smaller indices on the path of set2 to the root
 	set = set2;
@@ -538,14 +605,16 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 	}
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion(
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+bool DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::quickUnion(
 		disjoint_sets::LinkOption<LinkOptions::Rank>,
-		disjoint_sets::InterleavingOption<InterleavingOptions::Tarjan>, int set1, int set2) {
-	int r_x = set1;
-	int r_y = set2;
-	int p_r_x = m_parents[r_x];
-	int p_r_y = m_parents[r_y];
+		disjoint_sets::InterleavingOption<InterleavingOptions::Tarjan>, IndexType set1,
+		IndexType set2) {
+	IndexType r_x = set1;
+	IndexType r_y = set2;
+	IndexType p_r_x = m_parents[r_x];
+	IndexType p_r_y = m_parents[r_y];
 	while (p_r_x != p_r_y) {
 		if (m_parameters[p_r_x] <= m_parameters[p_r_y]) {
 			if (r_x == p_r_x) {
@@ -572,9 +641,10 @@ bool DisjointSets<linkOption, compressionOption, interleavingOption>::quickUnion
 }
 
 //link
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
-		disjoint_sets::LinkOption<LinkOptions::Index>, int set1, int set2) {
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::link(
+		disjoint_sets::LinkOption<LinkOptions::Index>, IndexType set1, IndexType set2) {
 	if (set1 < set2) {
 		m_parents[set1] = set2;
 		return set2;
@@ -584,11 +654,12 @@ int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
 	}
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
-		disjoint_sets::LinkOption<LinkOptions::Rank>, int set1, int set2) {
-	int parameter1 = m_parameters[set1];
-	int parameter2 = m_parameters[set2];
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::link(
+		disjoint_sets::LinkOption<LinkOptions::Rank>, IndexType set1, IndexType set2) {
+	IndexType parameter1 = m_parameters[set1];
+	IndexType parameter2 = m_parameters[set2];
 
 	if (parameter1 < parameter2) {
 		m_parents[set1] = set2;
@@ -603,11 +674,12 @@ int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
 	}
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
-		disjoint_sets::LinkOption<LinkOptions::Size>, int set1, int set2) {
-	int parameter1 = m_parameters[set1];
-	int parameter2 = m_parameters[set2];
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::link(
+		disjoint_sets::LinkOption<LinkOptions::Size>, IndexType set1, IndexType set2) {
+	IndexType parameter1 = m_parameters[set1];
+	IndexType parameter2 = m_parameters[set2];
 
 	if (parameter1 < parameter2) {
 		m_parents[set1] = set2;
@@ -620,9 +692,10 @@ int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
 	}
 }
 
-template<LinkOptions linkOption, CompressionOptions compressionOption, InterleavingOptions interleavingOption>
-int DisjointSets<linkOption, compressionOption, interleavingOption>::link(
-		disjoint_sets::LinkOption<LinkOptions::Naive>, int set1, int set2) {
+template<LinkOptions linkOption, CompressionOptions compressionOption,
+		InterleavingOptions interleavingOption, typename IndexType>
+IndexType DisjointSets<linkOption, compressionOption, interleavingOption, IndexType>::link(
+		disjoint_sets::LinkOption<LinkOptions::Naive>, IndexType set1, IndexType set2) {
 	m_parents[set1] = set2;
 	return set2;
 }
@@ -0,0 +1,117 @@
+/** \file
+ * \brief A lazily sized scratch array that can be cleared in constant time.
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#pragma once
+
+#include <pctree/util/defines.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace pc_tree {
+
+/**
+ * Maps keys to values, storing the entry of a key at the position given by its \c index() method.
+ *
+ * In contrast to a RegisteredArray, the array is not resized when keys are added, but only grows
+ * when an entry with a larger index is written. Each entry is stamped with the epoch in which it
+ * was last written, so that clear() resets all entries to the default value in constant time by
+ * starting a new epoch. Stale entries are only overwritten with the default value when they are
+ * written again, so entries that hold their own memory (e.g. vectors) keep their capacity.
+ *
+ * @tparam Key A pointer to a type with an \c index() method, e.g. PCNode*.
+ * @tparam Value The type of the stored values.
+ */
+template<typename Key, typename Value>
+class EpochArray {
+	struct Entry {
+		size_t m_epoch = 0;
+		Value m_value;
+	};
+
+	std::vector<Entry> m_entries;
+	size_t m_epoch = 1;
+	Value m_default;
+
+public:
+	explicit EpochArray(const Value& def = Value()) : m_default(def) { }
+
+	/**
+	 * Returns a reference to the entry of \p key, which is reset to the default value if it was
+	 * not written since the last call to clear().
+	 *
+	 * The array may grow, so references to other entries are invalidated if \p key has a larger
+	 * index than all keys written before.
+	 */
+	Value& operator[](Key key) {
+		size_t index = key->index();
+		if (index >= m_entries.size()) {
+			m_entries.resize(std::max(index + 1, m_entries.size() * 2));
+		}
+		Entry& entry = m_entries[index];
+		if (entry.m_epoch != m_epoch) {
+			entry.m_epoch = m_epoch;
+			entry.m_value = m_default;
+		}
+		return entry.m_value;
+	}
+
+	//! Returns the value of \p key without writing to the array.
+	const Value& get(Key key) const {
+		size_t index = key->index();
+		if (index < m_entries.size() && m_entries[index].m_epoch == m_epoch) {
+			return m_entries[index].m_value;
+		}
+		return m_default;
+	}
+
+	//! Resets all entries to the default value in constant time.
+	void clear() {
+		if (++m_epoch == 0) {
+			// the epoch counter wrapped around, so old stamps might become valid again
+			for (Entry& entry : m_entries) {
+				entry.m_epoch = 0;
+			}
+			m_epoch = 1;
+		}
+	}
+
+	//! Clears the array and frees all memory held by it.
+	void release() {
+		std::vector<Entry>().swap(m_entries);
+		m_epoch = 1;
+	}
+
+	//! The number of entries the array currently has space for.
+	size_t capacity() const { return m_entries.size(); }
+};
+
+}
@@ -171,6 +171,34 @@ public:
 		check();
 	}
 
+	/**
+	 * Re-inserts \p obj at its old position after it was removed using erase(obj).
+	 * Only valid if all other changes made to this list since then were already reverted.
+	 */
+	void restore(T* obj) {
+		OGDF_ASSERT(obj != nullptr);
+		check();
+
+		if (obj->m_prev) {
+			OGDF_ASSERT(obj->m_prev->m_next == obj->m_next);
+			obj->m_prev->m_next = obj;
+		} else {
+			OGDF_ASSERT(m_first == obj->m_next);
+			m_first = obj;
+		}
+
+		if (obj->m_next) {
+			OGDF_ASSERT(obj->m_next->m_prev == obj->m_prev);
+			obj->m_next->m_prev = obj;
+		} else {
+			OGDF_ASSERT(m_last == obj->m_prev);
+			m_last = obj;
+		}
+
+		m_count++;
+		check();
+	}
+
 	void splice(iterator at, IntrusiveList<T>& other) {
 		OGDF_ASSERT(at == begin() || at == end());
 		check();
@@ -0,0 +1,209 @@
+/** \file
+ * \brief A sequence of integers with removal of blocks and position queries in logarithmic time.
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#pragma once
+
+#include <pctree/util/defines.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace pc_tree {
+
+/**
+ * A sequence of distinct non-negative integers, stored as binary tree ordered by position in which
+ * every node knows the size of its subtree.
+ *
+ * Blocks of consecutive elements can be removed and inserted and the position of an element can be
+ * queried in expected logarithmic time, while the sequence can be listed in linear time.
+ * The tree is kept balanced in expectation by randomly choosing the root when joining two trees,
+ * with a probability proportional to their sizes.
+ * Elements are used as index of their node, so the memory used is linear in the largest element.
+ */
+class OrderStatisticsTree {
+public:
+	static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+private:
+	struct Node {
+		size_t m_left = NONE;
+		size_t m_right = NONE;
+		size_t m_parent = NONE;
+		size_t m_size = 0;
+	};
+
+	std::vector<Node> m_nodes;
+	size_t m_root = NONE;
+	std::minstd_rand m_random;
+
+public:
+	//! The number of elements in the sequence.
+	size_t size() const { return sizeOf(m_root); }
+
+	//! Replaces the sequence by the elements of \p elements in this order.
+	void assign(const std::vector<size_t>& elements) {
+		size_t max = 0;
+		for (size_t element : elements) {
+			max = std::max(max, element + 1);
+		}
+		if (m_nodes.size() < max) {
+			m_nodes.resize(max);
+		}
+		m_root = build(elements, 0, elements.size());
+	}
+
+	//! The position of \p element, which must be contained in the sequence.
+	size_t position(size_t element) const {
+		OGDF_ASSERT(element < m_nodes.size());
+		size_t position = sizeOf(m_nodes[element].m_left);
+		for (size_t node = element, parent = m_nodes[node].m_parent; parent != NONE;
+				node = parent, parent = m_nodes[node].m_parent) {
+			if (m_nodes[parent].m_right == node) {
+				position += sizeOf(m_nodes[parent].m_left) + 1;
+			}
+		}
+		OGDF_ASSERT(position < size());
+		return position;
+	}
+
+	//! Removes the \p count elements starting at position \p begin from the sequence.
+	void erase(size_t begin, size_t count) {
+		OGDF_ASSERT(begin + count <= size());
+		auto [front, rest] = split(m_root, begin);
+		auto [block, back] = split(rest, count);
+		m_root = join(front, back);
+		setParent(m_root, NONE);
+	}
+
+	/**
+	 * Inserts the \p elements, which must not be contained in the sequence, in this order before
+	 * position \p begin.
+	 */
+	void insert(size_t begin, const std::vector<size_t>& elements) {
+		OGDF_ASSERT(begin <= size());
+		auto [front, back] = split(m_root, begin);
+		size_t block = build(elements, 0, elements.size());
+		m_root = join(join(front, block), back);
+		setParent(m_root, NONE);
+	}
+
+	//! Calls \p f for all elements of the sequence in this order.
+	template<typename Function>
+	void forEach(Function f) const {
+		std::vector<size_t> stack;
+		size_t node = m_root;
+		while (node != NONE || !stack.empty()) {
+			while (node != NONE) {
+				stack.push_back(node);
+				node = m_nodes[node].m_left;
+			}
+			node = stack.back();
+			stack.pop_back();
+			f(node);
+			node = m_nodes[node].m_right;
+		}
+	}
+
+private:
+	size_t sizeOf(size_t node) const { return node == NONE ? 0 : m_nodes[node].m_size; }
+
+	void setParent(size_t node, size_t parent) {
+		if (node != NONE) {
+			m_nodes[node].m_parent = parent;
+		}
+	}
+
+	void setChildren(size_t node, size_t left, size_t right) {
+		Node& n = m_nodes[node];
+		n.m_left = left;
+		n.m_right = right;
+		n.m_size = sizeOf(left) + sizeOf(right) + 1;
+		setParent(left, node);
+		setParent(right, node);
+	}
+
+	//! Builds a balanced tree of \p elements[begin, end) and returns its root.
+	size_t build(const std::vector<size_t>& elements, size_t begin, size_t end) {
+		if (begin == end) {
+			return NONE;
+		}
+		size_t middle = begin + (end - begin) / 2;
+		size_t node = elements[middle];
+		OGDF_ASSERT(node < m_nodes.size());
+		setChildren(node, build(elements, begin, middle), build(elements, middle + 1, end));
+		m_nodes[node].m_parent = NONE;
+		return node;
+	}
+
+	//! Splits the tree rooted at \p node into one with its first \p count elements and the rest.
+	std::pair<size_t, size_t> split(size_t node, size_t count) {
+		if (node == NONE) {
+			return {NONE, NONE};
+		}
+		Node& n = m_nodes[node];
+		size_t leftSize = sizeOf(n.m_left);
+		if (count <= leftSize) {
+			auto [front, back] = split(n.m_left, count);
+			setChildren(node, back, n.m_right);
+			setParent(front, NONE);
+			return {front, node};
+		} else {
+			auto [front, back] = split(n.m_right, count - leftSize - 1);
+			setChildren(node, n.m_left, front);
+			setParent(back, NONE);
+			return {node, back};
+		}
+	}
+
+	//! Joins the trees rooted at \p front and \p back into one with all elements of \p front first.
+	size_t join(size_t front, size_t back) {
+		if (front == NONE) {
+			return back;
+		}
+		if (back == NONE) {
+			return front;
+		}
+		size_t frontSize = sizeOf(front);
+		if (m_random() % (frontSize + sizeOf(back)) < frontSize) {
+			setChildren(front, m_nodes[front].m_left, join(m_nodes[front].m_right, back));
+			return front;
+		} else {
+			setChildren(back, join(front, m_nodes[back].m_left), m_nodes[back].m_right);
+			return back;
+		}
+	}
+};
+
+}
@@ -35,6 +35,8 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace pc_tree {
@@ -121,6 +123,9 @@ public:
 
 private:
 	mutable registration_list_type m_registeredArrays;
+	//! Guards #m_registeredArrays while #m_concurrent, e.g. for the readers of a frozen PCTreeForest.
+	mutable std::mutex m_mutexRegArrays;
+	bool m_concurrent = false;
 	bool m_autoShrink = false;
 	int m_size = 0;
 
@@ -141,6 +146,10 @@ public:
 	 *         This iterator is required for unregistering the array again.
 	 */
 	OGDF_NODISCARD registration_iterator_type registerArray(registered_array_type* pArray) const {
+		std::unique_lock<std::mutex> guard(m_mutexRegArrays, std::defer_lock);
+		if (m_concurrent) {
+			guard.lock();
+		}
 		return m_registeredArrays.emplace(m_registeredArrays.end(), pArray);
 	}
 
@@ -149,11 +158,23 @@ public:
 	 * @param it An iterator pointing to the entry of the array in the list of all registered arrays.
 	 */
 	void unregisterArray(registration_iterator_type it) const noexcept {
+		std::unique_lock<std::mutex> guard;
+		if (m_concurrent) {
+			// in contrast to lock(), try_lock() doesn't throw
+			while (!m_mutexRegArrays.try_lock()) {
+				std::this_thread::yield();
+			}
+			guard = std::unique_lock<std::mutex>(m_mutexRegArrays, std::adopt_lock);
+		}
 		m_registeredArrays.erase(it);
 	}
 
 	//! Stores array \p pArray at position \p it in the list of registered arrays.
 	void moveRegisterArray(registration_iterator_type it, registered_array_type* pArray) const {
+		std::unique_lock<std::mutex> guard(m_mutexRegArrays, std::defer_lock);
+		if (m_concurrent) {
+			guard.lock();
+		}
 		*it = pArray;
 	}
 
@@ -225,6 +246,15 @@ public:
 	//! Returns a reference to the list of all registered arrays.
 	const registration_list_type& getRegisteredArrays() const { return m_registeredArrays; }
 
+	//! Returns whether arrays may be registered and unregistered concurrently.
+	bool isConcurrent() const { return m_concurrent; }
+
+	/**
+	 * Specifies whether arrays may be registered and unregistered concurrently, which then need to
+	 * take a lock. May only be changed while no other thread uses this registry.
+	 */
+	void setConcurrent(bool concurrent) { m_concurrent = concurrent; }
+
 	//! Returns whether the registry allows arrays to shrink when keys are removed.
 	bool isAutoShrink() const { return m_autoShrink; }
 
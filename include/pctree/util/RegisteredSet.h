@@ -33,6 +33,9 @@
 #include <pctree/util/RegisteredArray.h>
 #include <pctree/util/defines.h>
 
+#include <list>
+#include <vector>
+
 namespace pc_tree {
 
 //! Constant-time set operations.
@@ -180,4 +183,149 @@ private:
 	list_type m_elements;
 };
 
+
+//! Constant-time set operations on a dense array of elements.
+/**
+ * Maintains a subset of indexed keys managed by a registry, with the same interface as
+ * RegisteredSet.
+ *
+ * The elements are stored contiguously in a \c std::vector, and a registered array maps each
+ * element to its position in there. Removing an element moves the last element into its place, so
+ * insertion and deletion don't allocate (once the vector has grown large enough) and iterating
+ * the set doesn't chase pointers. In contrast to RegisteredSet, the elements are thus not iterated
+ * in the order they were inserted once an element was removed.
+ *
+ * @tparam Registry The class which manages the registered keys. Must provide the functions defined in
+ * class RegistryBase.
+ * @tparam SupportFastSizeQuery Only for compatibility with RegisteredSet, the #size of this set
+ * can always be queried in constant time.
+ *
+ * \sa RegisteredSet, RegisteredArray
+ */
+template<class Registry, bool SupportFastSizeQuery = true>
+class DenseRegisteredSet {
+public:
+	using element_type = typename Registry::key_type;
+	using list_type = typename std::vector<element_type>;
+	using iter_type = typename list_type::iterator;
+
+	//! Creates an empty set associated with registry \p R.
+	explicit DenseRegisteredSet(const Registry& R) : m_pos(R, -1) { }
+
+	//! Creates an empty set associated with no registry.
+	explicit DenseRegisteredSet() : m_pos(static_cast<const Registry*>(nullptr), -1) { }
+
+	//! Reinitializes the set. Associates the set with no registry.
+	void init() {
+		m_pos.init(nullptr, -1);
+		m_elements.clear();
+	}
+
+	//! Reinitializes the set. Associates the set with registry \p R.
+	void init(const Registry& R) {
+		m_pos.init(R, -1);
+		m_elements.clear();
+	}
+
+	//! Inserts element \p v into this set.
+	/**
+	 * This operation has (amortized) constant runtime.
+	 * If the element is already contained in this set, nothing happens.
+	 *
+	 * \pre \p v is an element in the associated registry.
+	 */
+	void insert(element_type v) {
+		int& posV = m_pos[v];
+		if (posV < 0) {
+			posV = m_elements.size();
+			m_elements.push_back(v);
+		}
+	}
+
+	//! Removes element \p v from this set and return \p true iff \p v was previously present.
+	/**
+	 * This operation has constant runtime.
+	 * If the element is not contained in this set, nothing happens and \p false is returned.
+	 * The last element of #elements() takes the place of \p v.
+	 *
+	 * \pre \p v is an element in the associated registry.
+	 */
+	bool remove(element_type v) {
+		int& posV = m_pos[v];
+		if (posV < 0) {
+			return false;
+		}
+		element_type last = m_elements.back();
+		m_elements[posV] = last;
+		m_pos[last] = posV;
+		m_elements.pop_back();
+		posV = -1;
+		return true;
+	}
+
+	//! Removes all elements from this set.
+	/**
+	 * After this operation, this set is empty and still associated with the same registry.
+	 * The runtime of this operation is linear in the #size(), the capacity of #elements() is kept.
+	 */
+	void clear() {
+		for (element_type v : m_elements) {
+			m_pos[v] = -1;
+		}
+		m_elements.clear();
+	}
+
+	//! Returns \c true iff element \p v is contained in this set.
+	/**
+	 * This operation has constant runtime.
+	 *
+	 * \pre \p v is an element in the associated registry.
+	 */
+	bool isMember(element_type v) const { return m_pos[v] >= 0; }
+
+	//! Returns the same as isMember() to use an DenseRegisteredSet instance as filter function.
+	bool operator()(element_type v) const { return isMember(v); }
+
+	//! Returns a reference to the vector of elements contained in this set.
+	const list_type& elements() const { return m_elements; }
+
+	//! Returns the associated registry.
+	const Registry* registeredAt() const { return m_pos.registeredAt(); }
+
+	//! Returns the number of elements in this set.
+	/**
+	 * This operation has constant runtime.
+	 */
+	int size() const { return m_elements.size(); }
+
+	typename list_type::const_iterator begin() const { return m_elements.begin(); }
+
+	typename list_type::const_iterator end() const { return m_elements.end(); }
+
+	//! Copy constructor.
+	template<bool OtherSupportsFastSizeQuery>
+	explicit DenseRegisteredSet(const DenseRegisteredSet<Registry, OtherSupportsFastSizeQuery>& other) {
+		*this = other;
+	}
+
+	//! Assignment operator.
+	template<bool OtherSupportsFastSizeQuery>
+	DenseRegisteredSet& operator=(
+			const DenseRegisteredSet<Registry, OtherSupportsFastSizeQuery>& other) {
+		m_elements.clear();
+		m_pos.init(other.registeredAt(), -1);
+		for (element_type v : other.elements()) {
+			insert(v);
+		}
+		return *this;
+	}
+
+private:
+	//! #m_pos[\a v] contains the index of \a v in #m_elements if \a v is contained in this set,
+	//! or -1 otherwise.
+	RegisteredArray<Registry, int> m_pos;
+
+	//! The elements contained in this set, in no particular order.
+	list_type m_elements;
+};
 }
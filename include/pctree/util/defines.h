@@ -33,12 +33,62 @@
 
 #include <pctree/util/copy_move.h>
 
-#include <cassert>
+#include <cstdio>
+#include <cstdlib>
 
 #define OGDF_EXPORT
 #define OGDF_NODISCARD
 #define OGDF_NEW_DELETE
-#define OGDF_DEBUG
-#define OGDF_ASSERT(x) assert(x)
-#define OGDF_HEAVY_ASSERT(x) assert(x)
 #define OGDF_DEPRECATED(x)
+
+/**
+ * Selects which consistency checks are compiled into the library.
+ *
+ * - 0: no checks at all, OGDF_ASSERT() and OGDF_HEAVY_ASSERT() expand to nothing.
+ * - 1: cheap checks, defines OGDF_DEBUG and enables OGDF_ASSERT().
+ * - 2: heavy checks, additionally defines OGDF_HEAVY_DEBUG and enables OGDF_HEAVY_ASSERT(),
+ *      which e.g. runs PCTree::checkValid() during every update.
+ *
+ * The CMake build sets this via the \c PCTREE_DEBUG_LEVEL cache variable and passes it on to all
+ * consumers of the PCTree target. If left undefined, it defaults to 0 when \c NDEBUG is set and to 2 otherwise.
+ * The same value must be used for building the library and for all code including its headers.
+ */
+#ifndef PCTREE_DEBUG_LEVEL
+#	ifdef NDEBUG
+#		define PCTREE_DEBUG_LEVEL 0
+#	else
+#		define PCTREE_DEBUG_LEVEL 2
+#	endif
+#endif
+
+#if PCTREE_DEBUG_LEVEL >= 1
+#	ifndef OGDF_DEBUG
+#		define OGDF_DEBUG
+#	endif
+#endif
+#if PCTREE_DEBUG_LEVEL >= 2
+#	ifndef OGDF_HEAVY_DEBUG
+#		define OGDF_HEAVY_DEBUG
+#	endif
+#endif
+
+namespace pc_tree {
+//! Reports a failed OGDF_ASSERT() or OGDF_HEAVY_ASSERT() and aborts, independently of \c NDEBUG.
+[[noreturn]] inline void assertionFailed(const char* expr, const char* file, int line) {
+	std::fprintf(stderr, "%s:%d: Assertion `%s' failed.\n", file, line, expr);
+	std::abort();
+}
+}
+
+#ifdef OGDF_DEBUG
+#	define OGDF_ASSERT(expr) \
+		((expr) ? static_cast<void>(0) : ::pc_tree::assertionFailed(#expr, __FILE__, __LINE__))
+#else
+#	define OGDF_ASSERT(expr) static_cast<void>(0)
+#endif
+
+#ifdef OGDF_HEAVY_DEBUG
+#	define OGDF_HEAVY_ASSERT(expr) OGDF_ASSERT(expr)
+#else
+#	define OGDF_HEAVY_ASSERT(expr) static_cast<void>(0)
+#endif
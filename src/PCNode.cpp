@@ -44,6 +44,7 @@ void PCNode::appendChild(PCNode* child, bool begin) {
 	OGDF_ASSERT(this != child);
 	OGDF_ASSERT(isValidNode());
 	OGDF_ASSERT(child->isValidNode(m_forest));
+	recordState();
 	child->setParent(this);
 	m_childCount++;
 	if (m_child1 == nullptr) {
@@ -82,6 +83,7 @@ void PCNode::insertBetween(PCNode* sib1, PCNode* sib2) {
 			OGDF_ASSERT(sib2->isValidNode(m_forest));
 			OGDF_ASSERT(parent->isValidNode(m_forest));
 			setParent(parent);
+			parent->recordState();
 			parent->m_childCount++;
 			sib1->replaceSibling(sib2, this);
 			sib2->replaceSibling(sib1, this);
@@ -112,6 +114,7 @@ void PCNode::insertBetween(PCNode* sib1, PCNode* sib2) {
 	OGDF_ASSERT(parent->isValidNode(m_forest));
 	OGDF_ASSERT(sib2 == nullptr || sib2->isValidNode(m_forest));
 	setParent(parent);
+	parent->recordState();
 	parent->m_childCount++;
 
 	sib1->replaceSibling(nullptr, this);
@@ -139,6 +142,10 @@ void PCNode::detach() {
 
 void PCNode::forceDetach() {
 	PCNode* parent = getParent();
+	recordState();
+	if (parent != nullptr) {
+		parent->recordState();
+	}
 	if (m_sibling1 != nullptr) {
 		m_sibling1->replaceSibling(this, m_sibling2);
 	} else if (parent != nullptr) {
@@ -167,6 +174,8 @@ void PCNode::replaceWith(PCNode* repl) {
 	OGDF_ASSERT(this != repl);
 	PCNode* parent = getParent();
 	OGDF_ASSERT(parent == nullptr || parent->isValidNode(m_forest));
+	recordState();
+	repl->recordState();
 	repl->m_parentCNodeId = m_parentCNodeId;
 	repl->m_parentPNode = m_parentPNode;
 	repl->m_sibling1 = m_sibling1;
@@ -197,8 +206,20 @@ void PCNode::mergeIntoParent() {
 	OGDF_ASSERT(parent->m_nodeType == PCNodeType::CNode);
 	OGDF_ASSERT(parent->isValidNode(m_forest));
 
+	OGDF_ASSERT(!m_forest->isFrozen());
+	recordState();
+	parent->recordState();
 	UnionFindIndex pcid = m_forest->m_parents.link(m_nodeListIndex, parent->m_nodeListIndex);
+	if (m_forest->isRecording()) {
+		m_forest->recordUndo(PCTreeForest::UndoRecord::Kind::Link, nullptr,
+				pcid == m_nodeListIndex ? parent->m_nodeListIndex : m_nodeListIndex);
+	}
 	if (pcid == this->m_nodeListIndex) {
+		if (m_forest->isRecording()) {
+			m_forest->recordUndo(PCTreeForest::UndoRecord::Kind::CNodeSlot, this, m_nodeListIndex);
+			m_forest->recordUndo(PCTreeForest::UndoRecord::Kind::CNodeSlot, parent,
+					parent->m_nodeListIndex);
+		}
 		std::swap(m_forest->m_cNodes[this->m_nodeListIndex],
 				m_forest->m_cNodes[parent->m_nodeListIndex]);
 		std::swap(this->m_nodeListIndex, parent->m_nodeListIndex);
@@ -232,6 +253,7 @@ void PCNode::mergeIntoParent() {
 void PCNode::replaceSibling(PCNode* oldS, PCNode* newS) {
 	OGDF_ASSERT((newS == nullptr) || (m_forest == newS->m_forest));
 	OGDF_ASSERT(newS != this);
+	recordState();
 	if (oldS == m_sibling1) {
 		m_sibling1 = newS;
 	} else {
@@ -243,6 +265,7 @@ void PCNode::replaceSibling(PCNode* oldS, PCNode* newS) {
 void PCNode::replaceOuterChild(PCNode* oldC, PCNode* newC) {
 	OGDF_ASSERT((newC == nullptr) || (m_forest == newC->m_forest));
 	OGDF_ASSERT(newC != this);
+	recordState();
 	if (oldC == m_child1) {
 		m_child1 = newC;
 	} else {
@@ -409,7 +432,7 @@ bool PCNode::isValidNode(const PCTreeForest* ofForest) const {
 
 	if (m_nodeType == PCNodeType::CNode) {
 		OGDF_ASSERT(m_forest->m_cNodes.at(m_nodeListIndex) == this);
-		return (size_t)m_forest->m_parents.find(m_nodeListIndex) == m_nodeListIndex;
+		return (size_t)m_forest->findCNodeSet(m_nodeListIndex) == m_nodeListIndex;
 	} else if (m_nodeType == PCNodeType::Leaf) {
 		OGDF_ASSERT(getDegree() <= 1);
 		// OGDF_ASSERT(forest->leaves.at(nodeListIndex) == this);
@@ -427,12 +450,17 @@ PCNode* PCNode::getParent() const {
 				|| m_parentPNode->m_nodeType == PCNodeType::Leaf);
 		return m_parentPNode;
 	} else if (m_parentCNodeId != UNIONFINDINDEX_EMPTY) {
-		m_parentCNodeId = m_forest->m_parents.find(m_parentCNodeId);
-		OGDF_ASSERT(m_forest->m_cNodes.at(m_parentCNodeId) != nullptr);
-		PCNode* parent = m_forest->m_cNodes[m_parentCNodeId];
+		UnionFindIndex parentId = m_forest->findCNodeSet(m_parentCNodeId);
+		if (!m_forest->isRecording() && !m_forest->isFrozen()) {
+			// a rollback could not restore the cached id, so only update it while not recording
+			// and don't write to shared state while concurrent readers may be active
+			m_parentCNodeId = parentId;
+		}
+		OGDF_ASSERT(m_forest->m_cNodes.at(parentId) != nullptr);
+		PCNode* parent = m_forest->m_cNodes[parentId];
 		OGDF_ASSERT(parent != this);
 		OGDF_ASSERT(parent->m_nodeType == PCNodeType::CNode);
-		OGDF_ASSERT(parent->m_nodeListIndex == m_parentCNodeId);
+		OGDF_ASSERT(parent->m_nodeListIndex == parentId);
 		return parent;
 	} else {
 		return nullptr;
@@ -442,6 +470,7 @@ PCNode* PCNode::getParent() const {
 void PCNode::setParent(PCNode* parent) {
 	OGDF_ASSERT(isDetached());
 	OGDF_ASSERT(parent != nullptr);
+	recordState();
 	if (parent->m_nodeType == PCNodeType::CNode) {
 		m_parentCNodeId = parent->m_nodeListIndex;
 	} else {
@@ -456,6 +485,7 @@ void PCNode::rotateChildOutside(bool child1) {
 
 	// parent must be root node
 	OGDF_ASSERT(parent->getParent() == nullptr);
+	parent->recordState();
 
 	/* rotate node to child1/2 of parent, children might be flipped but that's perfectly fine for a
      * CNode (and PNode as well) if parent is the root node */
@@ -568,14 +598,15 @@ bool PCTree::nextEmbedding() {
 	return false;
 }
 
-void PCNode::checkTimestamp() const {
+void PCNode::checkTimestamp() {
 	OGDF_ASSERT(isValidNode());
+	OGDF_ASSERT(!m_forest->isFrozen());
 	if (m_forest->m_timestamp != m_timestamp) {
 		OGDF_ASSERT(m_forest->m_timestamp > m_timestamp);
 		m_label = NodeLabel::Unknown;
 		m_timestamp = m_forest->m_timestamp;
 		if (!isLeaf()) {
-			m_temp.clear();
+			m_temp = m_forest->newTempInfo();
 		}
 	}
 }
@@ -0,0 +1,226 @@
+/** \file
+ * \brief Implementation of pc_tree::PCTreeBatchSolver
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#include <pctree/PCNode.h>
+#include <pctree/PCTree.h>
+#include <pctree/PCTreeBatchSolver.h>
+#include <pctree/PCTreeForest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace pc_tree;
+
+namespace {
+//! The range of instances a worker still has to solve. The owner takes chunks from the front, thieves from the back.
+struct WorkQueue {
+	std::mutex mutex;
+	size_t begin = 0;
+	size_t end = 0;
+};
+
+bool takeWork(std::vector<WorkQueue>& queues, size_t self, size_t chunkSize, size_t& begin,
+		size_t& end) {
+	WorkQueue& own = queues[self];
+	{
+		std::lock_guard<std::mutex> guard(own.mutex);
+		if (own.begin < own.end) {
+			begin = own.begin;
+			end = own.begin = std::min(own.end, own.begin + chunkSize);
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < queues.size(); i++) {
+		WorkQueue& victim = queues[(self + i) % queues.size()];
+		{
+			std::lock_guard<std::mutex> guard(victim.mutex);
+			if (victim.begin == victim.end) {
+				continue;
+			}
+			// steal the back half, rounded up so that a single remaining instance can also be stolen
+			end = victim.end;
+			begin = victim.end = end - (end - victim.begin + 1) / 2;
+		}
+		// only lock our own queue after releasing the victim's, so that two thieves can't deadlock
+		size_t split = std::min(end, begin + chunkSize);
+		std::lock_guard<std::mutex> guard(own.mutex);
+		own.begin = split;
+		own.end = end;
+		end = split;
+		return true;
+	}
+	return false;
+}
+
+//! Per-worker state that is reused for all instances solved by the worker.
+struct Worker {
+	PCTreeForest forest {false};
+	std::vector<PCNode*> leafNodes;
+	std::vector<PCNode*> restrictionLeaves;
+	std::vector<PCNode*> leafOrder;
+	std::vector<int> leafIndex;
+	// the last restriction that contained each leaf, counted over all instances of this worker
+	std::vector<size_t> leafRestriction;
+	size_t restrictionCount = 0;
+
+	void solve(const C1PInstance& instance, bool computeOrder, C1PResult& result) {
+		if (instance.leafCount < 0 || instance.offsets.empty()
+				|| instance.offsets.front() != 0 || instance.offsets.back() != instance.leaves.size()
+				|| !std::is_sorted(instance.offsets.begin(), instance.offsets.end())) {
+			throw std::invalid_argument(
+					"Invalid C1P instance! The offsets do not describe a partition of the leaves");
+		}
+		if (leafRestriction.size() < static_cast<size_t>(instance.leafCount)) {
+			leafRestriction.resize(instance.leafCount, 0);
+		}
+		for (size_t r = 0; r < instance.getRestrictionCount(); r++) {
+			restrictionCount++;
+			for (size_t i = instance.offsets[r]; i < instance.offsets[r + 1]; i++) {
+				int leaf = instance.leaves[i];
+				if (leaf < 0 || leaf >= instance.leafCount) {
+					throw std::invalid_argument("Invalid C1P instance! Leaf index "
+							+ std::to_string(leaf) + " is not in the range [0, "
+							+ std::to_string(instance.leafCount) + ")");
+				}
+				if (leafRestriction[leaf] == restrictionCount) {
+					throw std::invalid_argument("Invalid C1P instance! Restriction "
+							+ std::to_string(r) + " contains leaf " + std::to_string(leaf)
+							+ " twice");
+				}
+				leafRestriction[leaf] = restrictionCount;
+			}
+		}
+
+		if (instance.leafCount < 3) {
+			// too small for a PCTree, but every order is admissible
+			result.firstFailed = instance.getRestrictionCount();
+			if (computeOrder) {
+				result.order.resize(instance.leafCount);
+				std::iota(result.order.begin(), result.order.end(), 0);
+			}
+			return;
+		}
+
+		{
+			leafNodes.clear();
+			PCTree tree(instance.leafCount, &leafNodes, &forest);
+			restrictionLeaves.clear();
+			for (int leaf : instance.leaves) {
+				restrictionLeaves.push_back(leafNodes[leaf]);
+			}
+			result.firstFailed = tree.makeConsecutiveBatch(instance.offsets, restrictionLeaves);
+
+			if (computeOrder && result.isConsecutive(instance)) {
+				for (int i = 0; i < instance.leafCount; i++) {
+					size_t id = leafNodes[i]->index();
+					if (id >= leafIndex.size()) {
+						leafIndex.resize(id + 1);
+					}
+					leafIndex[id] = i;
+				}
+				leafOrder.clear();
+				tree.currentLeafOrder(leafOrder);
+				result.order.clear();
+				result.order.reserve(leafOrder.size());
+				for (PCNode* leaf : leafOrder) {
+					result.order.push_back(leafIndex[leaf->index()]);
+				}
+			}
+		}
+		// all nodes are gone, so this resets the node storage for reuse by the next instance
+		forest.clear();
+	}
+};
+}
+
+PCTreeBatchSolver::PCTreeBatchSolver(unsigned int threads, size_t chunkSize)
+	: m_threads(threads), m_chunkSize(std::max<size_t>(chunkSize, 1)) {
+	if (m_threads == 0) {
+		m_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+}
+
+std::vector<C1PResult> PCTreeBatchSolver::solve(const std::vector<C1PInstance>& instances,
+		bool computeOrder) const {
+	std::vector<C1PResult> results(instances.size());
+	// don't start workers that would not even get a single chunk
+	size_t threads = std::min<size_t>(m_threads, (instances.size() + m_chunkSize - 1) / m_chunkSize);
+	threads = std::max<size_t>(threads, 1);
+
+	std::vector<WorkQueue> queues(threads);
+	for (size_t t = 0; t < threads; t++) {
+		queues[t].begin = instances.size() * t / threads;
+		queues[t].end = instances.size() * (t + 1) / threads;
+	}
+
+	std::atomic<bool> failed {false};
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	auto work = [&](size_t self) {
+		try {
+			Worker worker;
+			size_t begin, end;
+			while (!failed && takeWork(queues, self, m_chunkSize, begin, end)) {
+				for (size_t i = begin; i < end; i++) {
+					worker.solve(instances[i], computeOrder, results[i]);
+				}
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> guard(errorMutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+			failed = true;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (size_t t = 1; t < threads; t++) {
+		pool.emplace_back(work, t);
+	}
+	work(0);
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	return results;
+}
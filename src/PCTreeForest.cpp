@@ -32,17 +32,26 @@
 #include <pctree/PCTree.h>
 #include <pctree/PCTreeForest.h>
 
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 using namespace pc_tree;
 
+namespace {
+// chunks grow geometrically from the first to the maximum size, unless more nodes are explicitly reserved
+const size_t FIRST_CHUNK_SIZE = 1 << 8;
+const size_t MAX_CHUNK_SIZE = 1 << 16;
+}
+
 PCTreeForest::~PCTreeForest() {
 	clear();
-#ifdef OGDF_PCTREE_REUSE_NODES
-	while (m_reusableNodes) {
-		PCNode* tmp = m_reusableNodes;
-		m_reusableNodes = m_reusableNodes->m_parentPNode;
-		delete tmp;
+	resetNodeStorage();
+	for (NodeChunk& chunk : m_nodeChunks) {
+		::operator delete(chunk.m_nodes);
 	}
-#endif
 }
 
 // forest auto deletes allocated trees when destructed
@@ -54,6 +63,7 @@ PCTree* PCTreeForest::makeTree() {
 }
 
 void PCTreeForest::clear() {
+	OGDF_ASSERT(!isRecording());
 	if (m_autodelete) {
 		for (auto* k : m_trees) {
 			delete k;
@@ -66,7 +76,218 @@ void PCTreeForest::clear() {
 	m_cNodes.shrink_to_fit();
 	m_parents.init();
 	m_nextNodeId = 0;
-	m_timestamp = 0;
+	m_nodesByID.clear();
+	m_timestamp = 1;
+	releaseTempInfos();
+	m_intersectScratch.release();
+	if (m_liveNodes == 0) {
+		resetNodeStorage();
+	}
+}
+
+void PCTreeForest::releaseTree(PCTree* tree) {
+	auto it = std::find(m_trees.begin(), m_trees.end(), tree);
+	if (it != m_trees.end()) {
+		m_trees.erase(it);
+	}
+}
+
+void PCTreeForest::freeze() {
+	OGDF_ASSERT(!isRecording());
+	m_parents.compressAll();
+	m_frozen = true;
+	m_nodeArrayRegistry.setConcurrent(true);
+}
+
+void PCTreeForest::compact() {
+	OGDF_ASSERT(!isRecording());
+	OGDF_ASSERT(!m_frozen);
+
+	size_t liveCNodes = 0;
+#ifdef OGDF_DEBUG
+	size_t liveNodes = 0;
+#endif
+	for (PCNode* node : m_nodesByID) {
+		if (node != nullptr && node->m_nodeType == PCNodeType::CNode) {
+			liveCNodes++;
+		}
+#ifdef OGDF_DEBUG
+		liveNodes += node != nullptr;
+#endif
+	}
+	// nodes that survived a clear() are missing from m_nodesByID and would keep stale IDs
+	OGDF_ASSERT(liveNodes == m_liveNodes);
+	OGDF_ASSERT(liveCNodes
+			<= static_cast<size_t>(std::numeric_limits<PCTreeUnionFindIndex>::max()));
+	m_parents.init(std::max(static_cast<PCTreeUnionFindIndex>(liveCNodes),
+			static_cast<PCTreeUnionFindIndex>(1 << 8)));
+	m_cNodes.clear();
+	m_cNodes.reserve(liveCNodes);
+
+	// new IDs are never larger than the old ones, so moving the entries in increasing order only
+	// swaps them with entries of destroyed nodes or entries that were already moved
+	size_t nextId = 0;
+	for (size_t id = 0; id < m_nodesByID.size(); ++id) {
+		PCNode* node = m_nodesByID[id];
+		if (node == nullptr) {
+			continue;
+		}
+		OGDF_ASSERT(node->m_id == id);
+		if (nextId != id) {
+			m_nodeArrayRegistry.swapArrayEntries(nextId, id);
+			node->m_id = nextId;
+			m_nodesByID[nextId] = node;
+		}
+		nextId++;
+
+		if (node->m_nodeType == PCNodeType::CNode) {
+			node->m_nodeListIndex = m_parents.makeSet();
+			OGDF_ASSERT(m_cNodes.size() == node->m_nodeListIndex);
+			m_cNodes.push_back(node);
+			PCNode* pred = nullptr;
+			PCNode* curr = node->m_child1;
+			while (curr != nullptr) {
+				OGDF_ASSERT(curr->m_parentPNode == nullptr);
+				curr->m_parentCNodeId = node->m_nodeListIndex;
+				proceedToNextSibling(pred, curr);
+			}
+		}
+	}
+	m_nodesByID.resize(nextId);
+	m_nodesByID.shrink_to_fit();
+	m_cNodes.shrink_to_fit();
+	m_nextNodeId = nextId;
+
+	// drop the entries of destroyed nodes, so that nodes reusing their IDs get the default values
+	m_nodeArrayRegistry.resizeArrays(nextId, true);
+	m_nodeArrayRegistry.resizeArrays(m_nodeArrayRegistry.calculateArraySize(0), true);
+	m_intersectScratch.release();
+	m_structureVersion++;
+}
+
+void PCTreeForest::reserveNodes(size_t count) {
+	size_t available = m_reusableNodeCount;
+	for (size_t i = m_activeChunk; i < m_nodeChunks.size() && available < count; ++i) {
+		available += m_nodeChunks[i].m_capacity - m_nodeChunks[i].m_used;
+	}
+	if (available >= count) {
+		return;
+	}
+	// skip the rest of the active chunk so that the reserved nodes are contiguous
+	NodeChunk chunk {static_cast<PCNode*>(::operator new(count * sizeof(PCNode))), count, 0};
+	m_activeChunk = m_nodeChunks.size();
+	m_nodeChunks.push_back(chunk);
+}
+
+PCNode* PCTreeForest::allocateNode(size_t id, PCNodeType type) {
+	m_liveNodes++;
+	if (m_reusableNodes) {
+		PCNode* node = m_reusableNodes;
+		m_reusableNodes = node->m_parentPNode;
+		m_reusableNodeCount--;
+		node->m_parentPNode = nullptr;
+		node->m_timestamp = 0;
+		node->m_id = id;
+		node->changeType(type);
+		setNodeID(node);
+		return node;
+	}
+
+	while (m_activeChunk < m_nodeChunks.size()
+			&& m_nodeChunks[m_activeChunk].m_used == m_nodeChunks[m_activeChunk].m_capacity) {
+		m_activeChunk++;
+	}
+	if (m_activeChunk == m_nodeChunks.size()) {
+		size_t capacity = m_nodeChunks.empty()
+				? FIRST_CHUNK_SIZE
+				: std::min(m_nodeChunks.back().m_capacity * 2, MAX_CHUNK_SIZE);
+		m_nodeChunks.push_back(
+				{static_cast<PCNode*>(::operator new(capacity * sizeof(PCNode))), capacity, 0});
+	}
+	NodeChunk& chunk = m_nodeChunks[m_activeChunk];
+	PCNode* node = new (chunk.m_nodes + chunk.m_used++) PCNode(this, id, type);
+	setNodeID(node);
+	return node;
+}
+
+void PCTreeForest::releaseNode(PCNode* node) {
+	OGDF_ASSERT(m_liveNodes > 0);
+	m_liveNodes--;
+	// the ID may already have been handed out again by a rollback
+	if (node->m_id < m_nodesByID.size() && m_nodesByID[node->m_id] == node) {
+		m_nodesByID[node->m_id] = nullptr;
+	}
+	node->m_parentPNode = m_reusableNodes;
+	m_reusableNodes = node;
+	m_reusableNodeCount++;
+}
+
+void PCTreeForest::setNodeID(PCNode* node) {
+	if (node->m_id >= m_nodesByID.size()) {
+		m_nodesByID.resize(std::max(node->m_id + 1, m_nodesByID.size() * 2), nullptr);
+	}
+	m_nodesByID[node->m_id] = node;
+}
+
+std::vector<PCNode*>* PCTreeForest::acquireWalkBuffer() {
+	{
+		// walks can only run concurrently while the forest is frozen
+		std::unique_lock<std::mutex> guard(m_walkBuffersMutex, std::defer_lock);
+		if (m_frozen) {
+			guard.lock();
+		}
+		if (!m_walkBuffers.empty()) {
+			std::vector<PCNode*>* buffer = m_walkBuffers.back().release();
+			m_walkBuffers.pop_back();
+			return buffer;
+		}
+	}
+	return new std::vector<PCNode*>();
+}
+
+void PCTreeForest::releaseWalkBuffer(std::vector<PCNode*>* buffer) noexcept {
+	std::unique_ptr<std::vector<PCNode*>> owned(buffer);
+	if (owned->capacity() > WALK_BUFFER_MAX_CAPACITY) {
+		return;
+	}
+	owned->clear();
+	std::unique_lock<std::mutex> guard(m_walkBuffersMutex, std::defer_lock);
+	if (m_frozen) {
+		guard.lock();
+	}
+	if (m_walkBuffers.size() < m_walkBuffers.capacity()) {
+		m_walkBuffers.push_back(std::move(owned));
+	}
+}
+
+void PCTreeForest::recordNodeState(PCNode* node) {
+	UndoRecord& record = m_undoLog.emplace_back();
+	record.m_kind = UndoRecord::Kind::NodeState;
+	record.m_node = node;
+	record.m_index = node->m_nodeListIndex;
+	record.m_parentCNodeId = node->m_parentCNodeId;
+	record.m_parentPNode = node->m_parentPNode;
+	record.m_sibling1 = node->m_sibling1;
+	record.m_sibling2 = node->m_sibling2;
+	record.m_child1 = node->m_child1;
+	record.m_child2 = node->m_child2;
+	record.m_childCount = node->m_childCount;
+	record.m_nodeType = node->m_nodeType;
+}
+
+void PCTreeForest::resetNodeStorage() {
+	OGDF_ASSERT(m_liveNodes == 0);
+	for (NodeChunk& chunk : m_nodeChunks) {
+		if constexpr (!std::is_trivially_destructible_v<PCNode>) {
+			for (size_t i = 0; i < chunk.m_used; ++i) {
+				chunk.m_nodes[i].~PCNode();
+			}
+		}
+		chunk.m_used = 0;
+	}
+	m_activeChunk = 0;
+	m_reusableNodes = nullptr;
+	m_reusableNodeCount = 0;
 }
 
 bool PCTreeRegistry::isKeyAssociated(PCNode* key) const {
@@ -82,3 +303,32 @@ int PCTreeRegistry::calculateArraySize(int add) const {
 }
 
 int PCTreeRegistry::maxKeyIndex() const { return m_pForest->m_nextNodeId - 1; }
+
+namespace pc_tree {
+std::ostream& operator<<(std::ostream& os, const PCTreeProfile::Phase phase) {
+	switch (phase) {
+	case PCTreeProfile::Phase::MarkFull:
+		return os << "MarkFull";
+	case PCTreeProfile::Phase::FindTerminalPath:
+		return os << "FindTerminalPath";
+	case PCTreeProfile::Phase::CreateCentralNode:
+		return os << "CreateCentralNode";
+	case PCTreeProfile::Phase::UpdateTerminalPath:
+		return os << "UpdateTerminalPath";
+	default:
+		OGDF_ASSERT(false);
+		return os << "Phase???";
+	}
+}
+
+std::ostream& operator<<(std::ostream& os, const PCTreeProfile& profile) {
+	for (size_t i = 0; i < PCTreeProfile::PhaseCount; ++i) {
+		auto phase = static_cast<PCTreeProfile::Phase>(i);
+		const PCTreeProfile::Counter& counter = profile[phase];
+		os << phase << ": " << counter.calls << " calls, "
+		   << std::chrono::duration_cast<std::chrono::microseconds>(counter.time).count() << "us"
+		   << std::endl;
+	}
+	return os;
+}
+}
@@ -32,9 +32,13 @@
 #include <pctree/PCNode.h>
 #include <pctree/PCTree.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <queue>
 #include <stack>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace pc_tree {
 
@@ -230,7 +234,7 @@ bool uid_utils::compareNodesByID(PCNode* a, PCNode* b) { return a->index() < b->
 
 std::ostream& PCTree::uniqueID(std::ostream& os,
 		const std::function<void(std::ostream& os, PCNode*, int)>& printNode,
-		const std::function<bool(PCNode*, PCNode*)>& compareNodes) {
+		const std::function<bool(PCNode*, PCNode*)>& compareNodes) const {
 	if (m_rootNode == nullptr) {
 		return os << "empty";
 	}
@@ -243,15 +247,38 @@ std::ostream& PCTree::uniqueID(std::ostream& os,
 		order[leaf] = i++;
 	}
 
-	PCNode* lastLeaf = sortedLeaves.back();
-	sortedLeaves.resize(m_leaves.size() - 1);
+	sortedLeaves.pop_back();
+
+	// Mark all but the last leaf full in the same way as markFull(It, It, std::vector<PCNode*>*), but
+	// using local arrays instead of the temporary information so that the tree is not modified.
 	std::vector<PCNode*> fullNodeOrder;
-	{
-		resetTempData();
-		markFull(sortedLeaves.begin(), sortedLeaves.end(), &fullNodeOrder);
-	}
-	for (PCNode* node : fullNodeOrder) {
-		order[node] = i++;
+	fullNodeOrder.reserve(m_pNodeCount + m_cNodeCount);
+	PCTreeNodeArray<bool> full(*this, false);
+	PCTreeNodeArray<size_t> fullNeighbors(*this, 0);
+	for (PCNode* full_node : sortedLeaves) {
+		while (full_node != nullptr) {
+			full[full_node] = true;
+			PCNode* partial_neigh = full_node->getParent();
+			if (partial_neigh == nullptr || full[partial_neigh]) {
+				PCNode* pred = nullptr;
+				partial_neigh = full_node->m_child1;
+				while (partial_neigh != nullptr && full[partial_neigh]) {
+					proceedToNextSibling(pred, partial_neigh);
+				}
+			}
+			OGDF_ASSERT(partial_neigh != nullptr);
+			if (partial_neigh->isLeaf()) {
+				OGDF_ASSERT(fullNodeOrder.size() == getPNodeCount() + getCNodeCount());
+				break;
+			}
+			if (++fullNeighbors[partial_neigh] == partial_neigh->getDegree() - 1) {
+				order[partial_neigh] = i++;
+				fullNodeOrder.push_back(partial_neigh);
+				full_node = partial_neigh;
+			} else {
+				full_node = nullptr;
+			}
+		}
 	}
 
 	std::stack<std::variant<PCNode*, std::string>> stack;
@@ -316,10 +343,11 @@ std::ostream& PCTree::uniqueID(std::ostream& os,
 				os << "(";
 				stack.push(")");
 			}
-			std::vector<PCNode*>& fullNeighbors = node->tempInfo().fullNeighbors;
-			children.assign(fullNeighbors.begin(), fullNeighbors.end());
-			if (node == fullNodeOrder.back()) {
-				children.push_back(lastLeaf);
+			// the full neighbors, and the last leaf for the last node, got their order before this node
+			for (PCNode* neigh : node->neighbors()) {
+				if (order[neigh] < order[node]) {
+					children.push_back(neigh);
+				}
 			}
 			children.sort([&order](PCNode* a, PCNode* b) { return order[a] < order[b]; });
 		} else {
@@ -328,9 +356,9 @@ std::ostream& PCTree::uniqueID(std::ostream& os,
 			continue;
 		}
 		if (node == fullNodeOrder.back()) {
-			OGDF_ASSERT(children.size() == node->tempInfo().fullNeighbors.size() + 1);
+			OGDF_ASSERT(children.size() == fullNeighbors[node] + 1);
 		} else {
-			OGDF_ASSERT(children.size() == node->tempInfo().fullNeighbors.size());
+			OGDF_ASSERT(children.size() == fullNeighbors[node]);
 		}
 		OGDF_ASSERT(order[children.front()] < order[children.back()]);
 
@@ -348,9 +376,102 @@ std::ostream& PCTree::uniqueID(std::ostream& os,
 	return os;
 }
 
+namespace {
+// the finalizer of splitmix64, so that similar inputs are spread over the whole range
+uint64_t mixHash(uint64_t x) {
+	x += 0x9e3779b97f4a7c15;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+	return x ^ (x >> 31);
+}
+
+const uint64_t HASH_BASE = 0x100000001b3;
+const uint64_t HASH_TAG_LEAF = 1;
+const uint64_t HASH_TAG_PNODE = 2;
+const uint64_t HASH_TAG_SEQUENCE = 3;
+}
+
+uint64_t PCTree::canonicalHash() const {
+	if (m_rootNode == nullptr) {
+		return 0;
+	}
+	// root the tree at the leaf with the smallest leaf index, which is independent of the actual
+	// root and of the node IDs within the forest
+	PCNode* first = *std::min_element(m_leaves.begin(), m_leaves.end(),
+			[](PCNode* a, PCNode* b) { return a->getLeafIndex() < b->getLeafIndex(); });
+
+	// collect the nodes together with their number of children when rooted at first in pre-order,
+	// visiting the children of each node in their cyclic order
+	std::vector<std::pair<PCNode*, size_t>> order;
+	order.reserve(getLeafCount() + m_pNodeCount + m_cNodeCount);
+	std::vector<std::pair<PCNode*, PCNode*>> stack {{first, nullptr}};
+	std::vector<PCNode*> neighbors;
+	while (!stack.empty()) {
+		auto [node, from] = stack.back();
+		stack.pop_back();
+		neighbors.clear();
+		if (node == first) {
+			if (node->getParent() != nullptr) {
+				neighbors.push_back(node->getParent());
+			} else if (node->getChildCount() > 0) {
+				neighbors.push_back(node->getOnlyChild());
+			}
+		} else if (!node->isLeaf()) {
+			PCNode* pred = from;
+			PCNode* curr = node->getNextNeighbor(nullptr, pred);
+			for (size_t i = 1; i < node->getDegree(); ++i) {
+				neighbors.push_back(curr);
+				if (i + 1 < node->getDegree()) {
+					node->proceedToNextNeighbor(pred, curr);
+				}
+			}
+		}
+		order.emplace_back(node, neighbors.size());
+		for (auto it = neighbors.rbegin(); it != neighbors.rend(); ++it) {
+			stack.emplace_back(*it, node);
+		}
+	}
+
+	// in reverse pre-order, the hashes of the children of a node are on top of the stack, the one
+	// visited first at the very top
+	std::vector<uint64_t> hashes;
+	for (auto it = order.rbegin(); it != order.rend(); ++it) {
+		auto [node, count] = *it;
+		OGDF_ASSERT(hashes.size() >= count);
+		uint64_t h;
+		if (node->isLeaf()) {
+			h = mixHash(HASH_TAG_LEAF ^ (node->getLeafIndex() << 2));
+			if (count > 0) {
+				h = mixHash(h + HASH_BASE * hashes.back());
+			}
+		} else if (node->m_nodeType == PCNodeType::PNode && node->getDegree() > 3) {
+			// children form a multiset, so combine them commutatively
+			uint64_t sum = 0;
+			for (size_t i = 0; i < count; ++i) {
+				sum += mixHash(hashes[hashes.size() - 1 - i]);
+			}
+			h = mixHash(HASH_TAG_PNODE ^ mixHash(sum + node->getDegree()));
+		} else {
+			// C-nodes and P-nodes with two children allow exactly their sequence of children and its reverse
+			uint64_t forward = 0, backward = 0, power = 1;
+			for (size_t i = 0; i < count; ++i) {
+				uint64_t child = hashes[hashes.size() - 1 - i];
+				forward = forward * HASH_BASE + child;
+				backward += child * power;
+				power *= HASH_BASE;
+			}
+			h = mixHash(HASH_TAG_SEQUENCE ^ mixHash(std::min(forward, backward)));
+		}
+		hashes.resize(hashes.size() - count);
+		hashes.push_back(h);
+	}
+	OGDF_ASSERT(hashes.size() == 1);
+	return hashes.back();
+}
+
 std::ostream& PCTree::uniqueIDRooted(std::ostream& os,
 		const std::function<void(std::ostream& os, PCNode*, int)>& printNode,
-		const std::function<bool(PCNode*, PCNode*)>& compareNodes, bool print_root) {
+		const std::function<bool(PCNode*, PCNode*)>& compareNodes, bool print_root) const {
 	if (m_rootNode == nullptr) {
 		return os << "empty";
 	}
@@ -448,43 +569,90 @@ std::ostream& operator<<(std::ostream& os, const NodeLabel l) {
 
 bool PCTree::isValidOrder(const std::vector<PCNode*>& order) const {
 	OGDF_ASSERT(order.size() == m_leaves.size());
-	PCTreeNodeArray<PCNode*> leafMapping(*this);
-	PCTree copy(*this, leafMapping);
-	PCNode* previous = nullptr;
-	for (PCNode* node : order) {
-		OGDF_ASSERT(node->m_forest == m_forest);
-		if (previous == nullptr) {
-			previous = node;
-			continue;
+	const size_t n = order.size();
+	if (n == 0) {
+		return true;
+	}
+
+	// the leaves in the subtree of each node must form a cyclic interval of positions in order
+	PCTreeNodeArray<size_t> start(*this, 0);
+	PCTreeNodeArray<size_t> length(*this, 0);
+	for (size_t i = 0; i < n; ++i) {
+		PCNode* leaf = order[i];
+		OGDF_ASSERT(leaf->m_forest == m_forest);
+		OGDF_ASSERT(leaf->isLeaf());
+		if (length[leaf] != 0) {
+			return false; // duplicate leaf
 		}
-		if (!copy.makeConsecutive({leafMapping[previous], leafMapping[node]})) {
-			return false;
+		start[leaf] = i;
+		length[leaf] = 1;
+	}
+	auto end = [&](PCNode* node) { return (start[node] + length[node] - 1) % n; };
+
+	// process all children before their parents by iterating a pre-order in reverse
+	std::vector<PCNode*> nodes;
+	nodes.reserve(getNodeCount());
+	nodes.push_back(m_rootNode);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		for (PCNode* child = nodes[i]->m_child1, *pred = nullptr; child != nullptr;
+				proceedToNextSibling(pred, child)) {
+			nodes.push_back(child);
 		}
-		previous = node;
 	}
-#ifdef OGDF_DEBUG
-	OGDF_ASSERT(copy.possibleOrders<int>() == 2);
-	OGDF_ASSERT(copy.makeConsecutive({leafMapping[order.front()], leafMapping[order.back()]}));
-	std::list<PCNode*> res_order;
-	copy.currentLeafOrder(res_order);
-	OGDF_ASSERT(res_order.size() == order.size());
-	for (size_t i = 0; res_order.front() != leafMapping[order.front()]; i++) {
-		res_order.push_back(res_order.front());
-		res_order.pop_front();
-		OGDF_ASSERT(i < order.size());
-	}
-	if (res_order.back() != leafMapping[order.back()]) {
-		std::reverse(res_order.begin(), res_order.end());
-		res_order.push_front(res_order.back());
-		res_order.pop_back();
-	}
-	OGDF_ASSERT(res_order.size() == order.size());
-	int i = 0;
-	for (PCNode* n : res_order) {
-		OGDF_ASSERT(n == leafMapping[order.at(i)]);
-		++i;
+
+	// stores which P-node last claimed a position as start of one of its children
+	std::vector<PCNode*> startOwner(n, nullptr);
+	for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+		PCNode* node = *it;
+		if (node->m_childCount == 0) {
+			if (length[node] == 0) {
+				return false; // leaf missing in order
+			}
+			continue;
+		}
+		const bool isRoot = node == m_rootNode;
+		size_t total = 0;
+		if (node->m_nodeType == PCNodeType::CNode) {
+			// the children need to be consecutive in their stored order or its reverse
+			bool forward = true, backward = true;
+			PCNode* pred = nullptr;
+			for (PCNode* child = node->m_child1, *childPred = nullptr; child != nullptr;
+					proceedToNextSibling(childPred, child)) {
+				total += length[child];
+				if (pred != nullptr) {
+					forward = forward && (end(pred) + 1) % n == start[child];
+					backward = backward && (end(child) + 1) % n == start[pred];
+				}
+				pred = child;
+			}
+			if (!forward && !backward) {
+				return false;
+			}
+			start[node] = forward ? start[node->m_child1] : start[node->m_child2];
+		} else if (!isRoot) {
+			// the union of the children needs to be an interval, so there may be only one child
+			// whose interval isn't directly followed by that of a sibling
+			OGDF_ASSERT(node->m_nodeType == PCNodeType::PNode);
+			for (PCNode* child = node->m_child1, *pred = nullptr; child != nullptr;
+					proceedToNextSibling(pred, child)) {
+				total += length[child];
+				startOwner[start[child]] = node;
+			}
+			PCNode* last = nullptr;
+			for (PCNode* child = node->m_child1, *pred = nullptr; child != nullptr;
+					proceedToNextSibling(pred, child)) {
+				if (startOwner[(end(child) + 1) % n] != node) {
+					if (last != nullptr) {
+						return false;
+					}
+					last = child;
+				}
+			}
+			OGDF_ASSERT(last != nullptr);
+			start[node] = (end(last) + n + 1 - total) % n;
+		}
+		length[node] = total;
 	}
-#endif
 
 	return true;
 }
@@ -656,8 +824,9 @@ bool PCTree::checkValid(bool allow_small_deg) const {
 			OGDF_ASSERT(curr->getParent() == node);
 			if (node->getNodeType() == PCNodeType::CNode) {
 				OGDF_ASSERT(curr->m_parentPNode == nullptr);
-				OGDF_ASSERT(curr->m_parentCNodeId
-						== node->m_nodeListIndex); // getParent() updates parentCNodeId
+				// getParent() updates parentCNodeId, unless a checkpoint is active
+				OGDF_ASSERT(curr->m_parentCNodeId == node->m_nodeListIndex
+						|| m_forest->isRecording());
 			} else {
 				OGDF_ASSERT(curr->m_parentPNode == node);
 				OGDF_ASSERT(curr->m_parentCNodeId == UNIONFINDINDEX_EMPTY);
@@ -790,6 +959,7 @@ PCNode* PCTree::setRoot(PCNode* newRoot) {
 PCNode* PCTree::changeRoot(PCNode* newRoot) {
 	OGDF_ASSERT(newRoot != nullptr && newRoot->isValidNode(m_forest));
 	OGDF_HEAVY_ASSERT(checkValid());
+	StructureChange change(*this);
 	std::stack<PCNode*> path;
 	for (PCNode* node = newRoot; node != nullptr; node = node->getParent()) {
 		OGDF_ASSERT(node != nullptr);
@@ -805,6 +975,7 @@ PCNode* PCTree::changeRoot(PCNode* newRoot) {
 			PCNode* sib1 = old_parent->getNextNeighbor(nullptr, new_parent);
 			PCNode* sib2 = old_parent->getNextNeighbor(sib1, new_parent);
 			new_parent->detach();
+			old_parent->recordState();
 			old_parent->m_child1->replaceSibling(nullptr, old_parent->m_child2);
 			old_parent->m_child2->replaceSibling(nullptr, old_parent->m_child1);
 			old_parent->m_child1 = sib1;
@@ -0,0 +1,250 @@
+/** \file
+ * \brief Implementation of the binary serialization of pc_tree::PCTree
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#include <pctree/PCNode.h>
+#include <pctree/PCTree.h>
+#include <pctree/PCTreeIterators.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#if __has_include(<sys/mman.h>)
+#	define PCTREE_HAS_MMAP
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace pc_tree;
+
+namespace {
+const uint32_t BINARY_MAGIC = 0x42544350; // "PCTB" when stored little-endian
+const uint32_t BINARY_VERSION = 1;
+const uint32_t BINARY_NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+struct BinaryHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t nodeCount;
+};
+
+// the input buffer may not be aligned, so don't dereference it directly
+template<typename T>
+T readBinary(const std::byte* data, size_t index) {
+	T value;
+	std::memcpy(&value, data + index * sizeof(T), sizeof(T));
+	return value;
+}
+
+template<typename T>
+void writeBinaryArray(std::ostream& os, const std::vector<T>& array) {
+	os.write(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+}
+}
+
+void PCTree::writeBinary(std::ostream& os) const {
+	size_t count = getNodeCount();
+	if (count >= BINARY_NO_PARENT) {
+		throw std::overflow_error("PC-Tree with " + std::to_string(count)
+				+ " nodes is too big for the binary format");
+	}
+	std::vector<uint32_t> ids;
+	std::vector<uint32_t> parents;
+	std::vector<uint8_t> types;
+	ids.reserve(count);
+	parents.reserve(count);
+	types.reserve(count);
+
+	if (m_rootNode != nullptr) {
+		PCTreeNodeArray<uint32_t> position(*this, BINARY_NO_PARENT);
+		for (PCNode* node : FilteringPCTreeWalk<true, true, AllPCNodes>(*this, m_rootNode)) {
+			if (node->index() >= BINARY_NO_PARENT) {
+				throw std::overflow_error("Node ID " + std::to_string(node->index())
+						+ " is too big for the binary format");
+			}
+			PCNode* parent = node->getParent();
+			position[node] = ids.size();
+			ids.push_back(node->index());
+			parents.push_back(parent != nullptr ? position[parent] : BINARY_NO_PARENT);
+			types.push_back(static_cast<uint8_t>(node->getNodeType()));
+		}
+	}
+	OGDF_ASSERT(ids.size() == count);
+
+	BinaryHeader header {BINARY_MAGIC, BINARY_VERSION, ids.size()};
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeBinaryArray(os, ids);
+	writeBinaryArray(os, parents);
+	writeBinaryArray(os, types);
+}
+
+PCTree::PCTree(const std::byte* data, size_t size, bool keep_ids, PCTreeForest* forest)
+	: PCTree(forest) {
+	if (size < sizeof(BinaryHeader)) {
+		throw std::invalid_argument("Invalid binary PC-Tree! Only " + std::to_string(size)
+				+ " bytes are too short for the header");
+	}
+	const BinaryHeader header = readBinary<BinaryHeader>(data, 0);
+	if (header.magic != BINARY_MAGIC) {
+		throw std::invalid_argument(
+				"Invalid binary PC-Tree! Wrong magic number, maybe it was written with a different byte order");
+	}
+	if (header.version != BINARY_VERSION) {
+		throw std::invalid_argument(
+				"Invalid binary PC-Tree! Unsupported version " + std::to_string(header.version));
+	}
+	const uint64_t count = header.nodeCount;
+	if (count >= BINARY_NO_PARENT
+			|| size != sizeof(BinaryHeader) + count * (2 * sizeof(uint32_t) + sizeof(uint8_t))) {
+		throw std::invalid_argument("Invalid binary PC-Tree! " + std::to_string(size)
+				+ " bytes do not match the size of " + std::to_string(count) + " nodes");
+	}
+	const std::byte* ids = data + sizeof(BinaryHeader);
+	const std::byte* parents = ids + count * sizeof(uint32_t);
+	const std::byte* types = parents + count * sizeof(uint32_t);
+
+	// validate everything before creating the first node, so that we never destruct an invalid tree
+	const uint8_t leafType = static_cast<uint8_t>(PCNodeType::Leaf);
+	std::vector<uint32_t> childCounts(count, 0);
+	uint64_t leafCount = 0;
+	std::vector<bool> usedIds;
+	for (uint64_t i = 0; i < count; ++i) {
+		uint32_t parent = readBinary<uint32_t>(parents, i);
+		uint8_t type = readBinary<uint8_t>(types, i);
+		if (type > leafType) {
+			throw std::invalid_argument("Invalid binary PC-Tree! Node " + std::to_string(i)
+					+ " has illegal type " + std::to_string(type));
+		}
+		if (i == 0 ? parent != BINARY_NO_PARENT : parent >= i) {
+			throw std::invalid_argument("Invalid binary PC-Tree! Node " + std::to_string(i)
+					+ " has illegal parent " + std::to_string(parent));
+		}
+		if (i > 0) {
+			childCounts[parent]++;
+		}
+		if (type == leafType) {
+			leafCount++;
+		}
+		if (keep_ids) {
+			uint32_t id = readBinary<uint32_t>(ids, i);
+			if (id > INT_MAX) {
+				throw std::invalid_argument("Invalid binary PC-Tree! Node " + std::to_string(i)
+						+ " has illegal ID " + std::to_string(id));
+			}
+			if (id >= usedIds.size()) {
+				usedIds.resize(std::max<size_t>(id + 1, usedIds.size() * 2));
+			}
+			if (usedIds[id]) {
+				throw std::invalid_argument("Invalid PC-Tree! Illegal re-use of ID "
+						+ std::to_string(id) + " with keep_ids=true at node " + std::to_string(i));
+			}
+			usedIds[id] = true;
+		}
+	}
+	// apply the degree constraints of PCTree::checkValid(): a leaf root may have a single child,
+	// while other leaves have none, and trees with less than three leaves have at most one inner
+	// node, which may have any degree, while all inner nodes of bigger trees need degree three
+	if (leafCount < 3 && count - leafCount > 1) {
+		throw std::invalid_argument("Invalid binary PC-Tree! " + std::to_string(count - leafCount)
+				+ " inner nodes are too many for " + std::to_string(leafCount) + " leaves");
+	}
+	for (uint64_t i = 0; i < count; ++i) {
+		uint8_t type = readBinary<uint8_t>(types, i);
+		size_t degree = childCounts[i] + (i > 0 ? 1 : 0);
+		if (type == leafType ? childCounts[i] > (i == 0 ? 1 : 0)
+							 : (leafCount >= 3 && degree < 3)) {
+			throw std::invalid_argument("Invalid binary PC-Tree! Node " + std::to_string(i)
+					+ " has illegal degree " + std::to_string(degree));
+		}
+	}
+
+	m_forest->reserveNodes(count);
+	std::vector<PCNode*> nodes(count);
+	for (uint64_t i = 0; i < count; ++i) {
+		uint32_t parent = readBinary<uint32_t>(parents, i);
+		nodes[i] = newNode(static_cast<PCNodeType>(readBinary<uint8_t>(types, i)),
+				parent != BINARY_NO_PARENT ? nodes[parent] : nullptr,
+				keep_ids ? static_cast<int>(readBinary<uint32_t>(ids, i)) : -1);
+	}
+	OGDF_HEAVY_ASSERT(checkValid());
+}
+
+std::unique_ptr<PCTree> PCTree::loadBinary(const std::string& path, bool keep_ids,
+		PCTreeForest* forest) {
+#ifdef PCTREE_HAS_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::runtime_error("Could not stat " + path + ": " + std::strerror(errno));
+	}
+	size_t size = st.st_size;
+	if (size == 0) {
+		close(fd);
+		return std::make_unique<PCTree>(nullptr, 0, keep_ids, forest);
+	}
+	void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		throw std::runtime_error("Could not map " + path + ": " + std::strerror(errno));
+	}
+	madvise(map, size, MADV_SEQUENTIAL);
+
+	struct Unmap {
+		void* map;
+		size_t size;
+
+		~Unmap() { munmap(map, size); }
+	} unmap {map, size};
+
+	return std::make_unique<PCTree>(static_cast<const std::byte*>(map), size, keep_ids, forest);
+#else
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in) {
+		throw std::runtime_error("Could not open " + path);
+	}
+	std::vector<std::byte> buffer(in.tellg());
+	in.seekg(0);
+	if (!in.read(reinterpret_cast<char*>(buffer.data()), buffer.size())) {
+		throw std::runtime_error("Could not read " + path);
+	}
+	return std::make_unique<PCTree>(buffer.data(), buffer.size(), keep_ids, forest);
+#endif
+}
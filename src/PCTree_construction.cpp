@@ -32,86 +32,194 @@
 #include <pctree/PCNode.h>
 #include <pctree/PCTree.h>
 
+#include <cctype>
+#include <climits>
+#include <istream>
 #include <regex>
-#include <stack>
+#include <string_view>
 
 using namespace pc_tree;
 
 PCTree::PCTree(int leafNum, std::vector<PCNode*>* added, PCTreeForest* forest) : PCTree(forest) {
 	OGDF_ASSERT(leafNum > 2);
+	m_forest->reserveNodes(leafNum + 1);
+	m_forest->m_nodeArrayRegistry.reserveSpace(leafNum + 1);
 	m_rootNode = newNode(PCNodeType::PNode);
 	insertLeaves(leafNum, m_rootNode, added);
 }
 
-PCTree::PCTree(const std::string& str, PCTreeNodeArray<std::string>* node_labels, bool keep_ids,
+namespace {
+bool isLabelChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+bool isSpaceChar(char c) { return std::isspace(static_cast<unsigned char>(c)); }
+
+//! Character source for PCTree::parse() reading from a string in memory.
+class StringSource {
+	std::string_view m_str;
+	size_t m_pos = 0;
+
+public:
+	explicit StringSource(std::string_view str) : m_str(str) { }
+
+	//! @return the current character or \c '\0' after the end of the input.
+	char peek() const { return m_pos < m_str.size() ? m_str[m_pos] : '\0'; }
+
+	void advance() { m_pos++; }
+
+	bool atEnd() const { return m_pos >= m_str.size(); }
+
+	size_t position() const { return m_pos; }
+};
+
+//! Character source for PCTree::parse() reading from a stream in chunks of fixed size.
+class StreamSource {
+	static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+	std::istream& m_is;
+	std::unique_ptr<char[]> m_buffer;
+	size_t m_offset = 0; //!< position of the start of #m_buffer within the stream
+	size_t m_size = 0;
+	size_t m_pos = 0;
+
+	void fill() {
+		m_offset += m_size;
+		m_is.read(m_buffer.get(), CHUNK_SIZE);
+		m_size = m_is.gcount();
+		m_pos = 0;
+	}
+
+public:
+	explicit StreamSource(std::istream& is) : m_is(is), m_buffer(new char[CHUNK_SIZE]) { fill(); }
+
+	//! @return the current character or \c '\0' after the end of the input.
+	char peek() const { return m_pos < m_size ? m_buffer[m_pos] : '\0'; }
+
+	void advance() {
+		m_pos++;
+		if (m_pos == m_size && m_size == CHUNK_SIZE) {
+			fill();
+		}
+	}
+
+	bool atEnd() const { return m_pos >= m_size; }
+
+	size_t position() const { return m_offset + m_pos; }
+};
+
+int parseID(const std::string& label, size_t pos) {
+	int id = 0;
+	for (char c : label) {
+		int digit = c - '0';
+		if (digit < 0 || digit > 9 || id > (INT_MAX - digit) / 10) {
+			throw std::invalid_argument("Invalid PC-Tree! Label '" + label + "' at position "
+					+ std::to_string(pos) + " is not a valid ID with keep_ids=true");
+		}
+		id = id * 10 + digit;
+	}
+	return id;
+}
+}
+
+PCTree::PCTree(std::string_view str, PCTreeNodeArray<std::string>* node_labels, bool keep_ids,
+		PCTreeForest* forest)
+	: PCTree(forest) {
+	StringSource source(str);
+	parse(source, node_labels, keep_ids);
+}
+
+PCTree::PCTree(std::istream& is, PCTreeNodeArray<std::string>* node_labels, bool keep_ids,
 		PCTreeForest* forest)
 	: PCTree(forest) {
+	StreamSource source(is);
+	parse(source, node_labels, keep_ids);
+}
+
+template<typename Source>
+void PCTree::parse(Source& source, PCTreeNodeArray<std::string>* node_labels, bool keep_ids) {
 	if (node_labels) {
 		node_labels->init(*this);
 	}
-	if (keep_ids) { // ensure that all IDs in the string are unique and the nextNodeId is one greater than the max of them
-		std::stringstream ss(str);
-		std::set<int> ids;
-		while (ss.good() && !ss.eof()) {
-			if (isdigit(ss.peek())) {
-				int idx;
-				ss >> idx;
-				if (!ids.insert(idx).second) {
+
+	std::vector<PCNode*> stack;
+	std::string next_label; // reused for all labels to avoid allocations
+
+	// With keep_ids, IDs are only checked for uniqueness once they are read. Nodes without label
+	// may thus get an ID that is only later used explicitly, in which case they are moved to a fresh ID.
+	std::vector<bool> used_ids;
+	std::vector<PCNode*> generated_ids;
+	auto createNode = [&](PCNodeType type, PCNode* parent, int id) {
+		if (keep_ids) {
+			if (id >= 0) {
+				if (static_cast<size_t>(id) >= used_ids.size()) {
+					used_ids.resize(std::max<size_t>(id + 1, used_ids.size() * 2));
+				}
+				if (used_ids[id]) {
 					throw std::invalid_argument("Invalid PC-Tree! Illegal re-use of ID "
-							+ std::to_string(idx) + " with keep_ids=true at position "
-							+ std::to_string(ss.tellg()));
+							+ std::to_string(id) + " with keep_ids=true at position "
+							+ std::to_string(source.position()));
 				}
-				m_forest->m_nextNodeId = std::max(m_forest->m_nextNodeId, idx + 1);
-			} else {
-				ss.ignore();
+				used_ids[id] = true;
+				if (static_cast<size_t>(id) < generated_ids.size() && generated_ids[id] != nullptr) {
+					PCNode* moved = generated_ids[id];
+					generated_ids[id] = nullptr;
+					moved->m_id = m_forest->m_nextNodeId++;
+					m_forest->setNodeID(moved);
+					m_forest->m_nodeArrayRegistry.keyAdded(moved);
+					generated_ids.resize(std::max(generated_ids.size(), moved->m_id + 1));
+					generated_ids[moved->m_id] = moved;
+				}
+			}
+			PCNode* node = newNode(type, parent, id);
+			if (id < 0) {
+				generated_ids.resize(std::max(generated_ids.size(), node->m_id + 1));
+				generated_ids[node->m_id] = node;
 			}
+			return node;
 		}
-	}
-
-	std::stack<PCNode*> stack;
+		return newNode(type, parent);
+	};
 
 #define THROW_INVALID                                                                              \
 	throw std::invalid_argument("Invalid PC-Tree! Illegal '" + std::string(1, next_char) + "' at " \
-			+ "position " + std::to_string(i) + " (parser line " + std::to_string(__LINE__) + ")");
+			+ "position " + std::to_string(source.position()) + " (parser line "                   \
+			+ std::to_string(__LINE__) + ")");
 
-	int i = 0;
-	while (i < str.length()) {
-		char next_char = str[i];
+	while (!source.atEnd()) {
+		char next_char = source.peek();
 
-		if (isspace(next_char)) {
-			i++;
+		if (isSpaceChar(next_char)) {
+			source.advance();
 			continue;
 		}
 
 		PCNode* new_node = nullptr;
-		PCNode* parent = stack.empty() ? nullptr : stack.top();
-		while (isalnum(next_char) || next_char == '_') {
-			std::string next_label;
-			while (i < str.length() && (isalnum(next_char) || next_char == '_')) {
+		PCNode* parent = stack.empty() ? nullptr : stack.back();
+		while (isLabelChar(next_char)) {
+			next_label.clear();
+			while (isLabelChar(next_char)) {
 				next_label.push_back(next_char);
-				i++;
-				next_char = str[i];
+				source.advance();
+				next_char = source.peek();
 			}
 
 			int next_id = -1;
 			if (keep_ids) {
-				next_id = std::stoi(next_label);
-				OGDF_ASSERT(next_id >= 0); // '-' would not be alnum
+				next_id = parseID(next_label, source.position());
 			}
 
 			if (parent == nullptr && getNodeCount() > 0) {
 				throw std::invalid_argument("Invalid PC-Tree! Second node '" + next_label + "' at "
-						+ "position " + std::to_string(i) + " cannot be at top level (parser line "
-						+ std::to_string(__LINE__) + ")");
+						+ "position " + std::to_string(source.position())
+						+ " cannot be at top level (parser line " + std::to_string(__LINE__) + ")");
 			}
-			new_node = newNode(PCNodeType::Leaf, parent, next_id);
+			new_node = createNode(PCNodeType::Leaf, parent, next_id);
 			if (node_labels) {
 				(*node_labels)[new_node] = next_label;
 			}
 
 			bool delim_seen = false;
-			while (i < str.length() && (isspace(next_char) || next_char == ':' || next_char == ',')) {
-				if (!isspace(next_char)) {
+			while (isSpaceChar(next_char) || next_char == ':' || next_char == ',') {
+				if (!isSpaceChar(next_char)) {
 					if (delim_seen) {
 						THROW_INVALID
 					}
@@ -120,8 +228,8 @@ PCTree::PCTree(const std::string& str, PCTreeNodeArray<std::string>* node_labels
 						new_node = nullptr; // cannot be used for P-/C-node after comma
 					}
 				}
-				i++;
-				next_char = str[i];
+				source.advance();
+				next_char = source.peek();
 			}
 		}
 
@@ -131,12 +239,12 @@ PCTree::PCTree(const std::string& str, PCTreeNodeArray<std::string>* node_labels
 				THROW_INVALID
 			}
 			if (!new_node) {
-				new_node = newNode(PCNodeType::Leaf);
+				new_node = createNode(PCNodeType::Leaf, nullptr, -1);
 			}
 			if (getLeafCount() != 1 || getNodeCount() != 1) {
 				THROW_INVALID
 			}
-			stack.push(new_node);
+			stack.push_back(new_node);
 			break;
 		case '[':
 			if (new_node) {
@@ -145,9 +253,9 @@ PCTree::PCTree(const std::string& str, PCTreeNodeArray<std::string>* node_labels
 				if (parent == nullptr && getNodeCount() > 0) {
 					THROW_INVALID // would create a second node at top level
 				}
-				new_node = newNode(PCNodeType::CNode, parent);
+				new_node = createNode(PCNodeType::CNode, parent, -1);
 			}
-			stack.push(new_node);
+			stack.push_back(new_node);
 			break;
 		case '(':
 			if (new_node) {
@@ -156,27 +264,27 @@ PCTree::PCTree(const std::string& str, PCTreeNodeArray<std::string>* node_labels
 				if (parent == nullptr && getNodeCount() > 0) {
 					THROW_INVALID // would create a second node at top level
 				}
-				new_node = newNode(PCNodeType::PNode, parent);
+				new_node = createNode(PCNodeType::PNode, parent, -1);
 			}
-			stack.push(new_node);
+			stack.push_back(new_node);
 			break;
 		case ']':
-			if (stack.empty() || stack.top()->m_nodeType != PCNodeType::CNode) {
+			if (stack.empty() || stack.back()->m_nodeType != PCNodeType::CNode) {
 				THROW_INVALID
 			}
-			stack.pop();
+			stack.pop_back();
 			break;
 		case ')':
-			if (stack.empty() || stack.top()->m_nodeType != PCNodeType::PNode) {
+			if (stack.empty() || stack.back()->m_nodeType != PCNodeType::PNode) {
 				THROW_INVALID
 			}
-			stack.pop();
+			stack.pop_back();
 			break;
 		case '}':
-			if (stack.empty() || stack.top()->m_nodeType != PCNodeType::Leaf) {
+			if (stack.empty() || stack.back()->m_nodeType != PCNodeType::Leaf) {
 				THROW_INVALID
 			}
-			stack.pop();
+			stack.pop_back();
 			if (!stack.empty()) {
 				THROW_INVALID
 			}
@@ -185,20 +293,21 @@ PCTree::PCTree(const std::string& str, PCTreeNodeArray<std::string>* node_labels
 			THROW_INVALID
 		}
 
-		i++;
-		next_char = str[i];
+		source.advance();
+		next_char = source.peek();
 		bool delim_seen = false;
-		while (i < str.length() && (isspace(next_char) || next_char == ',')) {
-			if (!isspace(next_char)) {
+		while (isSpaceChar(next_char) || next_char == ',') {
+			if (!isSpaceChar(next_char)) {
 				if (delim_seen) {
 					THROW_INVALID
 				}
 				delim_seen = true;
 			}
-			i++;
-			next_char = str[i];
+			source.advance();
+			next_char = source.peek();
 		}
 	}
+#undef THROW_INVALID
 	if (!stack.empty()) {
 		throw std::invalid_argument("Invalid PC-Tree! Unexpected end of string");
 	}
@@ -209,6 +318,7 @@ PCTree::PCTree(const PCTree& other, PCTreeNodeArray<PCNode*>& nodeMapping, bool
 		PCTreeForest* forest)
 	: PCTree(forest) {
 	nodeMapping.init(other);
+	m_forest->reserveNodes(other.getNodeCount());
 	for (PCNode* other_node : other.allNodes()) {
 		PCNode* parent = other_node->getParent();
 		int id = -1;
@@ -224,12 +334,22 @@ PCTree::PCTree(const PCTree& other, PCTreeNodeArray<PCNode*>& nodeMapping, bool
 		}
 	}
 	OGDF_ASSERT(nodeMapping[other.m_rootNode] == m_rootNode);
+	// use the same leaf indices as other
+	m_leavesByIndex.assign(other.m_leavesByIndex.size(), nullptr);
+	for (PCNode* other_leaf : other.m_leaves) {
+		PCNode* leaf = nodeMapping[other_leaf];
+		leaf->m_nodeListIndex = other_leaf->m_nodeListIndex;
+		m_leavesByIndex[leaf->m_nodeListIndex] = leaf;
+	}
 	OGDF_ASSERT(other.getLeafCount() == getLeafCount());
 	OGDF_ASSERT(other.getPNodeCount() == getPNodeCount());
 	OGDF_ASSERT(other.getCNodeCount() == getCNodeCount());
 }
 
 PCTree::~PCTree() {
+	while (m_forest->m_recordingTree == this) {
+		commit();
+	}
 	OGDF_ASSERT(checkValid());
 	// get rid of any degree <= 2 root, including a root leaf and possible degree 2 descendants
 	while (m_rootNode != nullptr && m_rootNode->m_childCount <= 2) {
@@ -277,6 +397,8 @@ PCTree::~PCTree() {
 		}
 	}
 
+	// the node array of the cache needs to be unregistered before the forest is deleted
+	m_leafOrderCache.reset();
 	if (!m_externalForest) {
 		delete m_forest;
 	}
@@ -287,58 +409,67 @@ PCTree::~PCTree() {
 }
 
 void PCTree::registerNode(PCNode* node) {
+	using Kind = PCTreeForest::UndoRecord::Kind;
 	if (node->m_nodeType == PCNodeType::Leaf) {
 		m_leaves.push_back(node);
+		node->m_nodeListIndex = m_leavesByIndex.size();
+		m_leavesByIndex.push_back(node);
+		if (m_forest->isRecording()) {
+			m_forest->recordUndo(Kind::LeafAdded, node);
+		}
 	} else if (node->m_nodeType == PCNodeType::PNode) {
 		m_pNodeCount++;
 	} else {
 		OGDF_ASSERT(node->m_nodeType == PCNodeType::CNode);
+		node->recordState();
 		node->m_nodeListIndex = m_forest->m_parents.makeSet();
 		OGDF_ASSERT(m_forest->m_cNodes.size() == node->m_nodeListIndex);
 		m_forest->m_cNodes.push_back(node);
+		if (m_forest->isRecording()) {
+			// the new set and slot are never removed, they just stay unused after a rollback
+			m_forest->recordUndo(Kind::CNodeSlot, nullptr, node->m_nodeListIndex);
+		}
 		m_cNodeCount++;
 	}
 }
 
 void PCTree::unregisterNode(PCNode* node) {
+	using Kind = PCTreeForest::UndoRecord::Kind;
 	if (node->m_nodeType == PCNodeType::Leaf) {
 		m_leaves.erase(node);
+		OGDF_ASSERT(m_leavesByIndex.at(node->m_nodeListIndex) == node);
+		m_leavesByIndex[node->m_nodeListIndex] = nullptr;
+		if (m_forest->isRecording()) {
+			m_forest->recordUndo(Kind::LeafRemoved, node, node->m_nodeListIndex);
+		}
+		node->m_nodeListIndex = UNIONFINDINDEX_EMPTY;
 	} else if (node->m_nodeType == PCNodeType::PNode) {
 		m_pNodeCount--;
 	} else {
 		OGDF_ASSERT(node->m_nodeType == PCNodeType::CNode);
 		OGDF_ASSERT(m_forest->m_cNodes.at(node->m_nodeListIndex) == node);
+		if (m_forest->isRecording()) {
+			node->recordState();
+			m_forest->recordUndo(Kind::CNodeSlot, node, node->m_nodeListIndex);
+		}
 		m_forest->m_cNodes[node->m_nodeListIndex] = nullptr;
 		m_cNodeCount--;
 		node->m_nodeListIndex = UNIONFINDINDEX_EMPTY;
 	}
 }
 
+template<typename Observers>
 PCNode* PCTree::newNode(PCNodeType type, PCNode* parent, int id) {
-	PCNode* node;
-#ifdef OGDF_PCTREE_REUSE_NODES
-	if (m_forest->m_reusableNodes) {
-		node = m_forest->m_reusableNodes;
-		m_forest->m_reusableNodes = m_forest->m_reusableNodes->m_parentPNode;
-		node->m_parentPNode = nullptr;
-		node->m_timestamp = 0;
-		if (id >= 0) {
-			node->m_id = id;
-			m_forest->m_nextNodeId = std::max(m_forest->m_nextNodeId, id + 1);
-		} // else we can't re-use the old ID after clear was called
-		else {
-			node->m_id = m_forest->m_nextNodeId++;
-		}
-		node->changeType(type);
-	} else
-#endif
-	{
-		if (id < 0) {
-			id = m_forest->m_nextNodeId++;
-		} else {
-			m_forest->m_nextNodeId = std::max(m_forest->m_nextNodeId, id + 1);
-		}
-		node = new PCNode(m_forest, id, type);
+	OGDF_ASSERT(!m_forest->isFrozen());
+	if (id < 0) {
+		id = m_forest->m_nextNodeId++;
+	} else {
+		m_forest->m_nextNodeId = std::max(m_forest->m_nextNodeId, id + 1);
+	}
+	StructureChange change(*this);
+	PCNode* node = m_forest->allocateNode(id, type);
+	if (m_forest->isRecording()) {
+		m_forest->recordUndo(PCTreeForest::UndoRecord::Kind::NodeCreated, node);
 	}
 	registerNode(node);
 	if (parent != nullptr) {
@@ -348,9 +479,7 @@ PCNode* PCTree::newNode(PCNodeType type, PCNode* parent, int id) {
 	}
 	m_forest->m_nodeArrayRegistry.keyAdded(node);
 
-	for (auto obs : m_observers) {
-		obs->onNodeCreate(node);
-	}
+	Observers::onNodeCreate(*this, node);
 
 	return node;
 }
@@ -362,13 +491,14 @@ void PCTree::destroyNode(PCNode* const& node) {
 	OGDF_ASSERT(node->m_child1 == nullptr);
 	OGDF_ASSERT(node->m_child2 == nullptr);
 	OGDF_ASSERT(node != m_rootNode);
+	StructureChange change(*this);
 	unregisterNode(node);
-#ifdef OGDF_PCTREE_REUSE_NODES
-	node->m_parentPNode = m_forest->m_reusableNodes;
-	m_forest->m_reusableNodes = node;
-#else
-	delete node;
-#endif
+	if (m_forest->isRecording()) {
+		// keep the storage alive so that the node can be restored by a rollback
+		m_forest->recordUndo(PCTreeForest::UndoRecord::Kind::NodeDestroyed, node);
+	} else {
+		m_forest->releaseNode(node);
+	}
 }
 
 PCNodeType PCTree::changeNodeType(PCNode* node, PCNodeType newType) {
@@ -377,6 +507,7 @@ PCNodeType PCTree::changeNodeType(PCNode* node, PCNodeType newType) {
 		return oldType;
 	}
 
+	StructureChange change(*this);
 #ifdef OGDF_DEBUG
 	UnionFindIndex oldIndex = node->m_nodeListIndex;
 #endif
@@ -393,11 +524,12 @@ PCNodeType PCTree::changeNodeType(PCNode* node, PCNodeType newType) {
 		while (curr != nullptr) {
 			if (oldType == PCNodeType::CNode) {
 				OGDF_ASSERT(curr->m_parentPNode == nullptr);
-				OGDF_ASSERT((size_t)m_forest->m_parents.find(curr->m_parentCNodeId) == oldIndex);
+				OGDF_ASSERT((size_t)m_forest->findCNodeSet(curr->m_parentCNodeId) == oldIndex);
 			} else {
 				OGDF_ASSERT(curr->m_parentPNode == node);
 				OGDF_ASSERT(curr->m_parentCNodeId == UNIONFINDINDEX_EMPTY);
 			}
+			curr->recordState();
 			if (newType == PCNodeType::CNode) {
 				curr->m_parentPNode = nullptr;
 				curr->m_parentCNodeId = node->m_nodeListIndex;
@@ -420,22 +552,68 @@ PCNodeType PCTree::changeNodeType(PCNode* node, PCNodeType newType) {
 void PCTree::insertLeaves(int count, PCNode* parent, std::vector<PCNode*>* added) {
 	OGDF_ASSERT(parent != nullptr);
 	OGDF_ASSERT(parent->m_forest == m_forest);
+	OGDF_ASSERT(!m_forest->isFrozen());
+	if (count <= 0) {
+		return;
+	}
+	StructureChange change(*this);
 	if (added) {
 		added->reserve(added->size() + count);
 	}
+
+	// reserve a contiguous range of IDs, the registered arrays are resized only once after the loop
+	m_forest->reserveNodes(count);
+	int firstId = m_forest->m_nextNodeId;
+	m_forest->m_nextNodeId += count;
+
+	// link the new leaves as a single sibling chain and append it to the children of parent
+	PCNode* first = nullptr;
+	PCNode* last = nullptr;
 	for (int i = 0; i < count; i++) {
-		PCNode* leaf = newNode(PCNodeType::Leaf);
-		parent->appendChild(leaf);
+		PCNode* leaf = m_forest->allocateNode(firstId + i, PCNodeType::Leaf);
+		if (m_forest->isRecording()) {
+			m_forest->recordUndo(PCTreeForest::UndoRecord::Kind::NodeCreated, leaf);
+		}
+		registerNode(leaf);
+		leaf->setParent(parent);
+		if (last != nullptr) {
+			leaf->m_sibling1 = last;
+			last->m_sibling2 = leaf;
+		} else {
+			first = leaf;
+		}
+		last = leaf;
 		if (added) {
 			added->push_back(leaf);
 		}
 	}
+	m_forest->m_nodeArrayRegistry.keyAdded(last);
+
+	parent->recordState();
+	if (parent->m_child2 != nullptr) {
+		PCNode* outerChild = parent->m_child2;
+		outerChild->recordState();
+		outerChild->replaceSibling(nullptr, first);
+		first->m_sibling1 = outerChild;
+	} else {
+		OGDF_ASSERT(parent->m_childCount == 0);
+		parent->m_child1 = first;
+	}
+	parent->m_child2 = last;
+	parent->m_childCount += count;
+
+	if (hasObservers()) {
+		for (PCNode* leaf = first; leaf != nullptr; leaf = leaf->m_sibling2) {
+			ObserverList::onNodeCreate(*this, leaf);
+		}
+	}
 }
 
 void PCTree::replaceLeaf(int leafCount, PCNode* leaf, std::vector<PCNode*>* added) {
 	OGDF_ASSERT(leaf && leaf->m_forest == m_forest);
 	OGDF_ASSERT(leaf->isLeaf());
 	OGDF_ASSERT(leafCount > 1);
+	StructureChange change(*this);
 	if (getLeafCount() <= 2) {
 		changeNodeType(leaf->getParent(), PCNodeType::PNode);
 		insertLeaves(leafCount, leaf->getParent(), added);
@@ -450,6 +628,7 @@ void PCTree::replaceLeaf(int leafCount, PCNode* leaf, std::vector<PCNode*>* adde
 void PCTree::destroyLeaf(PCNode* leaf) {
 	OGDF_ASSERT(leaf->getNodeType() == PCNodeType::Leaf);
 	OGDF_ASSERT(leaf != m_rootNode);
+	StructureChange change(*this);
 
 	PCNode* parent = leaf->getParent();
 	leaf->detach();
@@ -476,6 +655,8 @@ void PCTree::destroyLeaf(PCNode* leaf) {
 			} else if (child->getNodeType() != PCNodeType::Leaf) {
 				PCNode* root = m_rootNode;
 				root->detach();
+				root->recordState();
+				child->recordState();
 				root->m_childCount = 0;
 				root->m_child1 = root->m_child2 = nullptr;
 				child->m_parentCNodeId = UNIONFINDINDEX_EMPTY;
@@ -487,13 +668,54 @@ void PCTree::destroyLeaf(PCNode* leaf) {
 	}
 }
 
-void PCTree::insertTree(PCNode* at, PCTree* inserted) {
+void PCTree::insertTree(PCNode* at, PCTree* inserted, std::vector<PCNode*>* mapping) {
 	OGDF_HEAVY_ASSERT(checkValid());
 	OGDF_HEAVY_ASSERT(inserted->checkValid());
 	OGDF_ASSERT(at->isValidNode(getForest()));
-	OGDF_ASSERT(inserted->getForest() == getForest());
+	OGDF_ASSERT(!m_forest->isRecording());
+
+	bool copied = inserted->getForest() != getForest();
+	if (mapping != nullptr) {
+		mapping->clear();
+		for (PCNode* node : inserted->allNodes()) {
+			if (node->index() >= mapping->size()) {
+				mapping->resize(node->index() + 1, nullptr);
+			}
+			(*mapping)[node->index()] = node;
+		}
+		// the root is replaced by its only child until it has a different degree
+		PCNode* root = inserted->m_rootNode;
+		while (root != nullptr && root->getChildCount() == 1) {
+			(*mapping)[root->index()] = nullptr;
+			root = root->getOnlyChild();
+		}
+	}
+
+	if (copied) {
+		// nodes cannot be moved between forests, so rebuild the inserted tree within our forest
+		OGDF_ASSERT(!inserted->hasObservers());
+		PCTree* copy;
+		{
+			PCTreeNodeArray<PCNode*> nodeMapping(*inserted);
+			copy = new PCTree(*inserted, nodeMapping, false, m_forest);
+			if (mapping != nullptr) {
+				for (PCNode*& node : *mapping) {
+					if (node != nullptr) {
+						node = nodeMapping[node];
+					}
+				}
+			}
+		}
+		inserted->m_forest->releaseTree(inserted);
+		delete inserted;
+		inserted = copy;
+	}
 
 	m_observers.splice(m_observers.end(), inserted->m_observers);
+	for (PCNode* leaf : inserted->m_leaves) {
+		leaf->m_nodeListIndex = m_leavesByIndex.size();
+		m_leavesByIndex.push_back(leaf);
+	}
 	m_leaves.splice(m_leaves.end(), inserted->m_leaves);
 	m_pNodeCount += inserted->m_pNodeCount;
 	m_cNodeCount += inserted->m_cNodeCount;
@@ -501,6 +723,7 @@ void PCTree::insertTree(PCNode* at, PCTree* inserted) {
 	PCNode* root = inserted->m_rootNode;
 	inserted->m_rootNode = nullptr;
 	inserted->m_pNodeCount = inserted->m_cNodeCount = 0;
+	m_forest->releaseTree(inserted);
 	delete inserted;
 	inserted = nullptr;
 
@@ -537,3 +760,6 @@ void PCTree::insertTree(PCNode* at, PCTree* inserted) {
 	}
 	OGDF_ASSERT(checkValid());
 }
+
+template PCNode* PCTree::newNode<PCTree::NoObservers>(PCNodeType type, PCNode* parent, int id);
+template PCNode* PCTree::newNode<PCTree::ObserverList>(PCNodeType type, PCNode* parent, int id);
@@ -38,6 +38,7 @@ using namespace pc_tree;
 bool PCTree::intersect(PCTree& other, PCTreeNodeArray<PCNode*>& mapping) {
 	OGDF_HEAVY_ASSERT(checkValid() && other.checkValid());
 	OGDF_ASSERT(m_leaves.size() == other.m_leaves.size());
+	OGDF_ASSERT(!m_forest->isRecording() && !other.m_forest->isRecording());
 	OGDF_ASSERT(mapping.registeredAt() == &other.m_forest->m_nodeArrayRegistry);
 	if (other.isTrivial()) {
 		return true;
@@ -46,22 +47,22 @@ bool PCTree::intersect(PCTree& other, PCTreeNodeArray<PCNode*>& mapping) {
 #ifdef OGDF_DEBUG
 	size_t oldLeaves = m_leaves.size();
 #endif
-	PCTreeNodeArray<std::vector<PCNode*>> blockNodes(*this);
-	PCTreeNodeArray<std::vector<PCNode*>> subtreeNodes(*this);
-	PCTreeNodeArray<PCNode*> leafPartner(*this, nullptr);
-	PCTreeNodeArray<bool> isFront(*this, false);
-	bool possible = other.findNodeRestrictions(*this, mapping, blockNodes, subtreeNodes,
-			leafPartner, isFront);
-	restoreSubtrees(blockNodes, subtreeNodes, leafPartner, isFront);
+	// the scratch arrays only grow up to the largest ID touched and are cleared in constant time
+	PCTreeForest::IntersectScratch& scratch = m_forest->m_intersectScratch;
+	scratch.clear();
+	bool possible = other.findNodeRestrictions(*this, mapping, scratch);
+	restoreSubtrees(scratch);
 	OGDF_ASSERT(oldLeaves == m_leaves.size());
 
 	return possible;
 }
 
 bool PCTree::findNodeRestrictions(PCTree& applyTo, PCTreeNodeArray<PCNode*>& mapping,
-		PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
-		PCTreeNodeArray<std::vector<PCNode*>>& subtreeNodes, PCTreeNodeArray<PCNode*>& leafPartner,
-		PCTreeNodeArray<bool>& isFront) {
+		PCTreeForest::IntersectScratch& scratch) {
+	auto& blockNodes = scratch.m_blockNodes;
+	auto& subtreeNodes = scratch.m_subtreeNodes;
+	auto& leafPartner = scratch.m_leafPartner;
+	auto& isFront = scratch.m_isFront;
 	std::vector<PCNode*> fullNodeOrder;
 	resetTempData();
 	markFull(m_leaves.begin(), IntrusiveList<PCNode>::iterator(m_leaves.back()), &fullNodeOrder);
@@ -87,8 +88,8 @@ bool PCTree::findNodeRestrictions(PCTree& applyTo, PCTreeNodeArray<PCNode*>& map
 			OGDF_ASSERT(current->isLeaf());
 			consecutiveOther.push_back(current);
 			consecutiveOriginal.push_back(mapping[current]);
-			if (leafPartner[mapping[current]] != nullptr) {
-				consecutiveOriginal.push_back(leafPartner[mapping[current]]);
+			if (leafPartner.get(mapping[current]) != nullptr) {
+				consecutiveOriginal.push_back(leafPartner.get(mapping[current]));
 			}
 
 			if (node->getNodeType() == PCNodeType::CNode && consecutiveOther.size() >= 2) {
@@ -96,12 +97,12 @@ bool PCTree::findNodeRestrictions(PCTree& applyTo, PCTreeNodeArray<PCNode*>& map
 				PCNode* n1 = consecutiveOther[consecutiveOther.size() - 2];
 				PCNode* n2 = consecutiveOther.back();
 				pair.push_back(mapping[n1]);
-				if (leafPartner[mapping[n1]] != nullptr) {
-					pair.push_back(leafPartner[mapping[n1]]);
+				if (leafPartner.get(mapping[n1]) != nullptr) {
+					pair.push_back(leafPartner.get(mapping[n1]));
 				}
 				pair.push_back(mapping[n2]);
-				if (leafPartner[mapping[n2]] != nullptr) {
-					pair.push_back(leafPartner[mapping[n2]]);
+				if (leafPartner.get(mapping[n2]) != nullptr) {
+					pair.push_back(leafPartner.get(mapping[n2]));
 				}
 				if (!applyTo.makeConsecutive(pair)) {
 					return false;
@@ -176,14 +177,18 @@ bool PCTree::findNodeRestrictions(PCTree& applyTo, PCTreeNodeArray<PCNode*>& map
 			newLeaf->insertBetween(ebEnd1, ebEnd2);
 			if (newLeaf2 != nullptr) {
 				newLeaf2->insertBetween(newLeaf, ebEnd2);
-				subtreeNodes[newLeaf2] = subtreeNodes[newLeaf];
-				blockNodes[newLeaf2] = blockNodes[newLeaf];
+				// newLeaf2 has the larger ID, so accessing it first can't invalidate the other reference
+				std::vector<PCNode*>& subtree2 = subtreeNodes[newLeaf2];
+				subtree2 = subtreeNodes[newLeaf];
+				std::vector<PCNode*>& block2 = blockNodes[newLeaf2];
+				block2 = blockNodes[newLeaf];
 			}
 
 			for (PCNode* n : subtreeNodes[newLeaf]) {
-				int oldId = n->m_nodeListIndex;
+				// keep the union-find set of C-nodes and the index of leaves for restoreSubtrees()
+				UnionFindIndex oldId = n->m_nodeListIndex;
 				applyTo.unregisterNode(n);
-				if (n->getNodeType() == PCNodeType::CNode) {
+				if (n->getNodeType() != PCNodeType::PNode) {
 					n->m_nodeListIndex = oldId;
 				}
 			}
@@ -195,10 +200,12 @@ bool PCTree::findNodeRestrictions(PCTree& applyTo, PCTreeNodeArray<PCNode*>& map
 	return true;
 }
 
-void PCTree::restoreSubtrees(PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
-		PCTreeNodeArray<std::vector<PCNode*>>& subtreeNodes, PCTreeNodeArray<PCNode*>& leafPartner,
-		PCTreeNodeArray<bool>& isFront) {
-	PCTreeNodeArray<bool> visited(*this, false);
+void PCTree::restoreSubtrees(PCTreeForest::IntersectScratch& scratch) {
+	auto& blockNodes = scratch.m_blockNodes;
+	auto& subtreeNodes = scratch.m_subtreeNodes;
+	auto& leafPartner = scratch.m_leafPartner;
+	auto& isFront = scratch.m_isFront;
+	auto& visited = scratch.m_visited;
 	std::queue<PCNode*> queue;
 	queue.push(m_leaves.front()->getParent());
 
@@ -208,23 +215,23 @@ void PCTree::restoreSubtrees(PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
 
 		PCNode* previous = node->neighbors().m_first;
 		PCNode* current = node->getNextNeighbor(nullptr, previous);
-		if (leafPartner[current] != nullptr && leafPartner[current] == previous) {
+		if (leafPartner.get(current) != nullptr && leafPartner.get(current) == previous) {
 			previous = node->getNextNeighbor(previous, current);
 		}
 		int degree = node->neighbors().count();
 		for (int i = 0; i < degree; i++) {
 			OGDF_ASSERT(current->isValidNode(m_forest));
 
-			if (!blockNodes[current].empty()) {
+			if (!blockNodes.get(current).empty()) {
 				// Replace the merged leaf (or two leaves) with the subtree it represents.
 				visited[current] = true;
 				PCNode* neighbor1 = previous;
 				OGDF_ASSERT(node->areNeighborsAdjacent(current, previous));
-				PCNode* neighbor2 = leafPartner[current] == nullptr
+				PCNode* neighbor2 = leafPartner.get(current) == nullptr
 						? node->getNextNeighbor(previous, current)
-						: node->getNextNeighbor(current, leafPartner[current]);
+						: node->getNextNeighbor(current, leafPartner.get(current));
 				OGDF_ASSERT(neighbor1 != neighbor2);
-				if (!isFront[current]) {
+				if (!isFront.get(current)) {
 					std::reverse(blockNodes[current].begin(), blockNodes[current].end());
 				}
 
@@ -233,14 +240,18 @@ void PCTree::restoreSubtrees(PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
 						m_cNodeCount++;
 						OGDF_ASSERT(getForest()->m_cNodes.at(n->m_nodeListIndex) == nullptr);
 						getForest()->m_cNodes[n->m_nodeListIndex] = n;
+					} else if (n->getNodeType() == PCNodeType::Leaf) {
+						m_leaves.push_back(n);
+						OGDF_ASSERT(m_leavesByIndex.at(n->m_nodeListIndex) == nullptr);
+						m_leavesByIndex[n->m_nodeListIndex] = n;
 					} else {
 						registerNode(n);
 					}
 				}
 
 				current->detach();
-				if (leafPartner[current] != nullptr) {
-					leafPartner[current]->detach();
+				if (leafPartner.get(current) != nullptr) {
+					leafPartner.get(current)->detach();
 				}
 
 				for (PCNode* n : blockNodes[current]) {
@@ -252,12 +263,12 @@ void PCTree::restoreSubtrees(PCTreeNodeArray<std::vector<PCNode*>>& blockNodes,
 				PCNode* tmp = current;
 				current = blockNodes[current].front();
 				blockNodes[tmp].clear();
-				if (leafPartner[tmp] != nullptr) {
-					destroyNode(leafPartner[tmp]);
+				if (leafPartner.get(tmp) != nullptr) {
+					destroyNode(leafPartner.get(tmp));
 				}
 				destroyNode(tmp);
 			} else {
-				if (!current->isLeaf() && !visited[current]) {
+				if (!current->isLeaf() && !visited.get(current)) {
 					queue.push(current);
 				}
 				visited[current] = true;
@@ -32,38 +32,26 @@
 #include <pctree/PCNode.h>
 #include <pctree/PCTree.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <queue>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-#ifdef LIKWID_PERFMON
-
+// fine-grained profiling of sub-phases using LIKWID, see PCTreeProfile for the built-in per-phase timing
+#if defined(LIKWID_PERFMON) && defined(PC_PROFILE_LEVEL_2)
 #	include <likwid.h>
 
-#	define PC_PROFILE_ENTER(level, msg) PC_PROFILE_ENTER_##level(msg)
-#	define PC_PROFILE_EXIT(level, msg) PC_PROFILE_EXIT_##level(msg)
-
-#	ifdef PC_PROFILE_LEVEL_1
-#		define PC_PROFILE_ENTER_1(msg) likwid_markerStartRegion(msg)
-#		define PC_PROFILE_EXIT_1(msg) likwid_markerStopRegion(msg)
-#	else
-#		define PC_PROFILE_ENTER_1(msg)
-#		define PC_PROFILE_EXIT_1(msg)
-#	endif
-
-#	ifdef PC_PROFILE_LEVEL_2
-#		define PC_PROFILE_ENTER_2(msg) likwid_markerStartRegion(msg)
-#		define PC_PROFILE_EXIT_2(msg) likwid_markerStopRegion(msg)
-#	else
-#		define PC_PROFILE_ENTER_2(msg)
-#		define PC_PROFILE_EXIT_2(msg)
-#	endif
-
+#	define PC_PROFILE_ENTER(msg) likwid_markerStartRegion(msg)
+#	define PC_PROFILE_EXIT(msg) likwid_markerStopRegion(msg)
 #else
-#	define PC_PROFILE_ENTER(level, msg)
-#	define PC_PROFILE_EXIT(level, msg)
+#	define PC_PROFILE_ENTER(msg)
+#	define PC_PROFILE_EXIT(msg)
 #endif
 
 using namespace pc_tree;
@@ -107,6 +95,366 @@ bool PCTree::isTrivialRestriction(int size) const {
 	return ::isTrivialRestriction(size, getLeafCount());
 }
 
+size_t PCTree::makeConsecutiveBatch(const std::vector<size_t>& offsets,
+		const std::vector<PCNode*>& leaves, bool continueOnFailure, std::vector<size_t>* failed) {
+	OGDF_ASSERT(!offsets.empty());
+	OGDF_ASSERT(offsets.back() == leaves.size());
+	const size_t count = offsets.size() - 1;
+	// makeConsecutive never changes the number of leaves
+	const int leafCount = getLeafCount();
+	size_t firstFailure = count;
+	for (size_t i = 0; i < count; ++i) {
+		OGDF_ASSERT(offsets[i] <= offsets[i + 1]);
+		PCNode* const* begin = leaves.data() + offsets[i];
+		PCNode* const* end = leaves.data() + offsets[i + 1];
+		bool success;
+		if (hasObservers()) {
+			success = makeConsecutive(begin, end);
+		} else if (::isTrivialRestriction(end - begin, leafCount)) {
+			continue;
+		} else {
+			OGDF_HEAVY_ASSERT(checkValid());
+			resetTempData();
+			PCTREE_PROFILE_BEGIN(MarkFull);
+			markFull(begin, end);
+			PCTREE_PROFILE_END(MarkFull);
+			success = makeFullNodesConsecutive<NoObservers>();
+		}
+		if (!success) {
+			if (failed != nullptr) {
+				failed->push_back(i);
+			}
+			if (firstFailure == count) {
+				firstFailure = i;
+			}
+			if (!continueOnFailure) {
+				break;
+			}
+		}
+	}
+	return firstFailure;
+}
+
+namespace {
+int popCount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(word);
+#else
+	int count = 0;
+	for (; word != 0; word &= word - 1) {
+		count++;
+	}
+	return count;
+#endif
+}
+
+int lowestSetBit(uint64_t word) {
+	OGDF_ASSERT(word != 0);
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(word);
+#else
+	int bit = 0;
+	for (; (word & 1) == 0; word >>= 1) {
+		bit++;
+	}
+	return bit;
+#endif
+}
+}
+
+void PCTree::checkLeafIndex(size_t index) const {
+	if (getLeafByIndex(index) == nullptr) {
+		throw std::invalid_argument(
+				"Index " + std::to_string(index) + " does not belong to a leaf of this PC-tree");
+	}
+}
+
+bool PCTree::makeConsecutiveBitset(const uint64_t* words, size_t wordCount) {
+	// validate all bits before changing anything
+	size_t size = 0;
+	for (size_t w = 0; w < wordCount; ++w) {
+		size += popCount(words[w]);
+		for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+			checkLeafIndex(w * 64 + lowestSetBit(word));
+		}
+	}
+
+	if (hasObservers()) {
+		// observers need to be able to iterate the leaves repeatedly, so convert them to a list
+		std::vector<PCNode*> leaves;
+		leaves.reserve(size);
+		for (size_t w = 0; w < wordCount; ++w) {
+			for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+				leaves.push_back(m_leavesByIndex[w * 64 + lowestSetBit(word)]);
+			}
+		}
+		return makeConsecutive(leaves);
+	}
+	OGDF_HEAVY_ASSERT(checkValid());
+	resetTempData();
+	if (isTrivialRestriction(size)) {
+		return true;
+	}
+
+	PCTREE_PROFILE_BEGIN(MarkFull);
+	for (size_t w = 0; w < wordCount; ++w) {
+		for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+			PCNode* leaf = m_leavesByIndex[w * 64 + lowestSetBit(word)];
+			OGDF_ASSERT(leaf != nullptr);
+			OGDF_ASSERT(leaf->isLeaf());
+			PCNode* full_parent = markFull(leaf);
+			while (full_parent != nullptr) {
+				full_parent = markFull(full_parent);
+			}
+		}
+	}
+	PCTREE_PROFILE_END(MarkFull);
+
+	return makeFullNodesConsecutive();
+}
+
+PCTree::LeafOrderCache& PCTree::validLeafOrderCache() {
+	if (m_leafOrderCache == nullptr) {
+		m_leafOrderCache = std::make_unique<LeafOrderCache>();
+	}
+	LeafOrderCache& cache = *m_leafOrderCache;
+	if (cache.m_version != m_structureVersion
+			|| cache.m_forestVersion != m_forest->m_structureVersion
+			|| cache.m_leafIndices.size() != getLeafCount()) {
+		cache.m_block.clear();
+		for (PCNode* node : allNodes()) {
+			if (node->isLeaf()) {
+				cache.m_block.push_back(node->getLeafIndex());
+			}
+		}
+		cache.m_leafIndices.assign(cache.m_block);
+		cache.m_orderValid = false;
+		cache.m_version = m_structureVersion;
+		cache.m_forestVersion = m_forest->m_structureVersion;
+	}
+	return cache;
+}
+
+const std::vector<PCNode*>& PCTree::cachedLeafOrder() {
+	LeafOrderCache& cache = validLeafOrderCache();
+	if (!cache.m_orderValid) {
+		cache.m_order.clear();
+		cache.m_order.reserve(getLeafCount());
+		cache.m_leafIndices.forEach(
+				[&](size_t index) { cache.m_order.push_back(m_leavesByIndex[index]); });
+		cache.m_orderValid = true;
+	}
+	return cache.m_order;
+}
+
+PCTree::LeafOrderBlock PCTree::findLeafOrderBlock() {
+	LeafOrderBlock block;
+	if (m_leafOrderCache == nullptr || m_leafOrderCache->m_version != m_structureVersion
+			|| m_leafOrderCache->m_forestVersion != m_forest->m_structureVersion) {
+		return block;
+	}
+	block.m_valid = true;
+	OrderStatisticsTree& order = m_leafOrderCache->m_leafIndices;
+	// the leaves of a subtree are the block of the order between its first and last leaf,
+	// which are found by following the first and last child, as allNodes() visits the children
+	// from m_child2 to m_child1
+	auto firstPosition = [&](PCNode* node) {
+		while (!node->isLeaf()) {
+			node = node->m_child2;
+		}
+		return order.position(node->getLeafIndex());
+	};
+	auto lastPosition = [&](PCNode* node) {
+		while (!node->isLeaf()) {
+			node = node->m_child1;
+		}
+		return order.position(node->getLeafIndex());
+	};
+
+	PCNode::TempInfo& atinfo = m_apexCandidate->tempInfo();
+	PCNode* parent = m_apexCandidate->getParent();
+	bool isParentFull = parent != nullptr && parent->isFull();
+	size_t emptyNeighbors = m_apexCandidate->getDegree() - atinfo.fullNeighbors.size();
+	if (m_apexTPPred2 != nullptr) {
+		emptyNeighbors -= 2;
+	} else if (atinfo.tpPred != nullptr) {
+		emptyNeighbors -= 1;
+	}
+	if (m_terminalPathLength == 1
+			&& (m_apexCandidate->m_nodeType == PCNodeType::CNode || atinfo.fullNeighbors.size() <= 1
+					|| emptyNeighbors <= 1)) {
+		// updateSingletonTerminalPath() changes nothing
+		block.m_parent = m_apexCandidate;
+		return block;
+	}
+
+	// the leaves of the full and partial children of the apex, ordered by their position
+	struct ChildBlock {
+		size_t m_begin;
+		size_t m_end;
+		PCNode* m_child;
+
+		bool operator<(const ChildBlock& other) const { return m_begin < other.m_begin; }
+	};
+
+	std::vector<ChildBlock> children;
+	auto addChild = [&](PCNode* child) {
+		children.push_back({firstPosition(child), lastPosition(child) + 1, child});
+	};
+	if (!isParentFull
+			&& (m_apexCandidate->m_nodeType == PCNodeType::CNode || m_terminalPathLength == 1
+					|| emptyNeighbors > 1)) {
+		if (atinfo.tpPred != nullptr) {
+			addChild(atinfo.tpPred);
+		}
+		if (m_apexTPPred2 != nullptr) {
+			addChild(m_apexTPPred2);
+		}
+		for (PCNode* fullNeigh : atinfo.fullNeighbors) {
+			addChild(fullNeigh);
+		}
+		std::sort(children.begin(), children.end());
+		block.m_parent = m_apexCandidate;
+	}
+
+	if (!children.empty() && m_apexCandidate->m_nodeType == PCNodeType::CNode) {
+		// the partial children are merged into the apex in place and the full children are the
+		// ones between them, so the changed children form a single block, which may only wrap
+		// around from the last to the first child if the apex is the root
+		auto main = children.begin() + 1;
+		while (main != children.end() && main->m_begin == (main - 1)->m_end) {
+			++main;
+		}
+		if (main == children.end()) {
+			main = children.begin();
+		} else {
+			OGDF_ASSERT(m_apexCandidate == m_rootNode);
+			OGDF_ASSERT(children.front().m_begin == 0);
+			OGDF_ASSERT(children.back().m_end == order.size());
+			block.m_wrapSize = (main - 1)->m_end;
+			PCNode* last = (main - 1)->m_child;
+			for (PCNode* sibling : {last->m_sibling1, last->m_sibling2}) {
+				if (sibling != nullptr && firstPosition(sibling) >= block.m_wrapSize) {
+					block.m_wrapAfter = sibling;
+				}
+			}
+		}
+#ifdef OGDF_DEBUG
+		for (auto it = main + 1; it < children.end(); ++it) {
+			OGDF_ASSERT(it->m_begin == (it - 1)->m_end);
+		}
+#endif
+		block.m_begin = main->m_begin;
+		block.m_size = children.back().m_end - block.m_begin;
+		// the siblings of the outermost changed children that are not changed delimit the block
+		PCNode* first = main->m_child;
+		for (PCNode* sibling : {first->m_sibling1, first->m_sibling2}) {
+			if (sibling != nullptr && firstPosition(sibling) < block.m_begin) {
+				block.m_before = sibling;
+				block.m_beforePred = sibling->getNextSibling(first);
+			}
+		}
+		PCNode* last = children.back().m_child;
+		for (PCNode* sibling : {last->m_sibling1, last->m_sibling2}) {
+			if (sibling != nullptr && firstPosition(sibling) >= children.back().m_end) {
+				block.m_after = sibling;
+			}
+		}
+		order.erase(block.m_begin, block.m_size);
+		order.erase(0, block.m_wrapSize);
+		block.m_begin -= block.m_wrapSize;
+		return block;
+	}
+
+	if (!children.empty()) {
+		// all full and partial children of the P-node apex are moved to a new child, which is
+		// inserted before all other children, so that its leaves start the block of the apex
+		block.m_begin = firstPosition(m_apexCandidate);
+		block.m_anchor = children.front().m_child;
+		while (!block.m_anchor->isLeaf()) {
+			block.m_anchor = block.m_anchor->m_child2;
+		}
+		// remove the blocks from back to front, so that the positions of the others don't change
+		for (auto it = children.rbegin(); it != children.rend(); ++it) {
+			order.erase(it->m_begin, it->m_end - it->m_begin);
+			block.m_size += it->m_end - it->m_begin;
+		}
+		return block;
+	}
+
+	// the apex is replaced, so all leaves of its subtree are updated
+	block.m_parent = parent;
+	if (block.m_parent == nullptr) {
+		return block;
+	}
+	block.m_begin = firstPosition(m_apexCandidate);
+	block.m_size = lastPosition(m_apexCandidate) + 1 - block.m_begin;
+	block.m_anchor = m_apexCandidate;
+	while (!block.m_anchor->isLeaf()) {
+		block.m_anchor = block.m_anchor->m_child2;
+	}
+	order.erase(block.m_begin, block.m_size);
+	return block;
+}
+
+void PCTree::updateLeafOrderBlock(const LeafOrderBlock& block) {
+	if (!block.m_valid || block.m_parent == nullptr) {
+		// the root changed, so the order will be recomputed once it is needed
+		return;
+	}
+	LeafOrderCache& cache = *m_leafOrderCache;
+	std::vector<size_t>& leafIndices = cache.m_block;
+	leafIndices.clear();
+	auto addLeaves = [&](PCNode* subtree) {
+		for (PCNode* node : FilteringPCTreeWalk<true, false, AllPCNodes>(*this, subtree)) {
+			if (node->isLeaf()) {
+				leafIndices.push_back(node->getLeafIndex());
+			}
+		}
+	};
+	auto insertLeaves = [&](size_t begin, size_t size) {
+		OGDF_ASSERT(leafIndices.size() == size);
+		if (size > 0) {
+			cache.m_leafIndices.insert(begin, leafIndices);
+			cache.m_orderValid = false;
+		}
+		leafIndices.clear();
+	};
+	// the leaves of the children of m_parent from the one after pred up to the one before after
+	auto addRun = [&](PCNode* pred, PCNode* curr, PCNode* after) {
+		while (curr != after) {
+			OGDF_ASSERT(curr != nullptr);
+			addLeaves(curr);
+			proceedToNextSibling(pred, curr);
+		}
+	};
+	if (block.m_anchor != nullptr) {
+		// find the node that now contains the block
+		PCNode* subtree = block.m_anchor;
+		while (subtree->getParent() != block.m_parent) {
+			subtree = subtree->getParent();
+			OGDF_ASSERT(subtree != nullptr);
+		}
+		addLeaves(subtree);
+		insertLeaves(block.m_begin, block.m_size);
+	} else if (block.m_size > 0) {
+		if (block.m_before == nullptr) {
+			addRun(nullptr, block.m_parent->m_child2, block.m_after);
+		} else {
+			addRun(block.m_before, block.m_before->getNextSibling(block.m_beforePred),
+					block.m_after);
+		}
+		insertLeaves(block.m_begin, block.m_size);
+		if (block.m_wrapSize > 0) {
+			addRun(nullptr, block.m_parent->m_child2, block.m_wrapAfter);
+			insertLeaves(0, block.m_wrapSize);
+		}
+	}
+	cache.m_version = m_structureVersion;
+	cache.m_forestVersion = m_forest->m_structureVersion;
+	OGDF_HEAVY_ASSERT(cachedLeafOrder() == currentLeafOrder());
+}
+
 void PCTree::LoggingObserver::makeConsecutiveCalled(PCTree& tree, FullLeafIter consecutiveLeaves) {
 	log << "Tree " << tree << " with consecutive leaves [";
 	auto it = consecutiveLeaves();
@@ -194,71 +542,63 @@ void PCTree::LoggingObserver::makeConsecutiveDone(PCTree& tree, Stage stage, boo
 
 extern int PCTREE_DEBUG_CHECK_CNT;
 
+template<typename Observers>
 bool PCTree::makeFullNodesConsecutive() {
+	StructureChange change(*this);
 	if (m_firstPartial == nullptr) {
 		OGDF_ASSERT(m_lastPartial == nullptr);
 		OGDF_ASSERT(m_partialCount == 0);
-		for (auto obs : m_observers) {
-			obs->makeConsecutiveDone(*this, Observer::Stage::NoPartials, true);
-		}
+		Observers::makeConsecutiveDone(*this, Observer::Stage::NoPartials, true);
 		return true;
 	}
 	OGDF_ASSERT(m_lastPartial != nullptr);
 	OGDF_ASSERT(m_partialCount > 0);
-	for (auto obs : m_observers) {
-		obs->labelsAssigned(*this, m_firstPartial, m_lastPartial, m_partialCount);
-	}
+	Observers::labelsAssigned(*this, m_firstPartial, m_lastPartial, m_partialCount);
 
-	PC_PROFILE_ENTER(1, "find_tp");
+	PCTREE_PROFILE_BEGIN(FindTerminalPath);
 	bool find_tp = findTerminalPath();
-	PC_PROFILE_EXIT(1, "find_tp");
+	PCTREE_PROFILE_END(FindTerminalPath);
 	if (!find_tp) {
-		for (auto obs : m_observers) {
-			obs->makeConsecutiveDone(*this, Observer::Stage::InvalidTP, false);
-		}
+		Observers::makeConsecutiveDone(*this, Observer::Stage::InvalidTP, false);
 		return false;
 	}
 	OGDF_ASSERT(m_apexCandidate != nullptr);
 	OGDF_ASSERT(m_apexCandidateIsFix == true);
-	for (auto obs : m_observers) {
-		obs->terminalPathFound(*this, m_apexCandidate, m_apexTPPred2, m_terminalPathLength);
-	}
+	Observers::terminalPathFound(*this, m_apexCandidate, m_apexTPPred2, m_terminalPathLength);
+	LeafOrderBlock leafOrderBlock = findLeafOrderBlock();
 
-	PC_PROFILE_ENTER(1, "update_tp");
 	if (m_terminalPathLength == 1) {
 		OGDF_ASSERT(m_apexCandidate->tempInfo().tpPred == nullptr);
-		updateSingletonTerminalPath();
-		PC_PROFILE_EXIT(1, "update_tp");
-		for (auto obs : m_observers) {
-			obs->makeConsecutiveDone(*this, Observer::Stage::SingletonTP, true);
-		}
+		PCTREE_PROFILE_BEGIN(UpdateTerminalPath);
+		updateSingletonTerminalPath<Observers>();
+		PCTREE_PROFILE_END(UpdateTerminalPath);
+		updateLeafOrderBlock(leafOrderBlock);
+		Observers::makeConsecutiveDone(*this, Observer::Stage::SingletonTP, true);
 		return true;
 	}
 	OGDF_ASSERT(m_apexCandidate->tempInfo().tpPred != nullptr);
-	PC_PROFILE_ENTER(2, "update_tp_central");
-	PCNode* central = createCentralNode();
-	PC_PROFILE_EXIT(2, "update_tp_central");
-	for (auto obs : m_observers) {
-		obs->centralCreated(*this, central);
-	}
+	PCTREE_PROFILE_BEGIN(CreateCentralNode);
+	PCNode* central = createCentralNode<Observers>();
+	PCTREE_PROFILE_END(CreateCentralNode);
+	Observers::centralCreated(*this, central);
 
+	PCTREE_PROFILE_BEGIN(UpdateTerminalPath);
 	PCNode::TempInfo& ctinfo = central->tempInfo();
 #ifdef OGDF_DEBUG
 	size_t merged =
 #endif
-			updateTerminalPath(central, ctinfo.tpPred);
+			updateTerminalPath<Observers>(central, ctinfo.tpPred);
 	if (m_apexTPPred2 != nullptr) {
 #ifdef OGDF_DEBUG
 		merged +=
 #endif
-				updateTerminalPath(central, m_apexTPPred2);
+				updateTerminalPath<Observers>(central, m_apexTPPred2);
 	}
 	OGDF_ASSERT(merged == m_terminalPathLength - 1);
-	PC_PROFILE_EXIT(1, "update_tp");
+	PCTREE_PROFILE_END(UpdateTerminalPath);
+	updateLeafOrderBlock(leafOrderBlock);
 
-	for (auto obs : m_observers) {
-		obs->makeConsecutiveDone(*this, Observer::Stage::Done, true);
-	}
+	Observers::makeConsecutiveDone(*this, Observer::Stage::Done, true);
 #ifdef OGDF_HEAVY_DEBUG
 	OGDF_HEAVY_ASSERT(checkValid());
 	if (PCTREE_DEBUG_CHECK_FREQ != 0 && PCTREE_DEBUG_CHECK_CNT % PCTREE_DEBUG_CHECK_FREQ == 0) {
@@ -286,6 +626,15 @@ bool PCTree::makeFullNodesConsecutive() {
 	return true;
 }
 
+bool PCTree::canMakeFullNodesConsecutive() {
+	if (m_firstPartial == nullptr) {
+		OGDF_ASSERT(m_lastPartial == nullptr);
+		OGDF_ASSERT(m_partialCount == 0);
+		return true;
+	}
+	return findTerminalPath();
+}
+
 void PCTree::addPartialNode(PCNode* partial) {
 	OGDF_ASSERT(partial->tempInfo().predPartial == nullptr);
 	OGDF_ASSERT(partial->tempInfo().nextPartial == nullptr);
@@ -329,13 +678,13 @@ PCNode* PCTree::markFull(PCNode* full_node, std::vector<PCNode*>* fullNodeOrder)
 	PCNode* partial_neigh = full_node->getParent();
 	if (partial_neigh == nullptr || partial_neigh->isFull()) {
 		// if we are the root or our parent node got full before us, we need to find our one non-full neighbor
-		PC_PROFILE_ENTER(2, "label_process_neigh");
+		PC_PROFILE_ENTER("label_process_neigh");
 		PCNode* pred = nullptr;
 		partial_neigh = full_node->m_child1;
 		while (partial_neigh != nullptr && partial_neigh->isFull()) {
 			proceedToNextSibling(pred, partial_neigh);
 		}
-		PC_PROFILE_EXIT(2, "label_process_neigh");
+		PC_PROFILE_EXIT("label_process_neigh");
 	}
 	OGDF_ASSERT(partial_neigh != nullptr);
 	OGDF_ASSERT(!partial_neigh->isFull());
@@ -370,14 +719,14 @@ bool PCTree::checkTPPartialCNode(PCNode* node) {
 	// check that C node's full neighbors are consecutive
 	PCNode::TempInfo& tinfo = node->tempInfo();
 	if (tinfo.ebEnd1 == nullptr) {
-		PC_PROFILE_ENTER(2, "find_tp_cnode");
+		PC_PROFILE_ENTER("find_tp_cnode");
 		PCNode* fullChild = tinfo.fullNeighbors.front();
 		PCNode* sib1 = node->getNextNeighbor(nullptr, fullChild);
 		PCNode* sib2 = node->getNextNeighbor(sib1, fullChild);
 		size_t count = 1;
 		count += findEndOfFullBlock(node, fullChild, sib1, tinfo.fbEnd1, tinfo.ebEnd1);
 		count += findEndOfFullBlock(node, fullChild, sib2, tinfo.fbEnd2, tinfo.ebEnd2);
-		PC_PROFILE_EXIT(2, "find_tp_cnode");
+		PC_PROFILE_EXIT("find_tp_cnode");
 		if (count != tinfo.fullNeighbors.size()) {
 			log << "C-node's full-block isn't consecutive, abort!" << std::endl;
 			return false;
@@ -565,6 +914,7 @@ bool PCTree::findTerminalPath() {
 	return true;
 }
 
+template<typename Observers>
 PCNode* PCTree::createCentralNode() {
 	PCNode::TempInfo& atinfo = m_apexCandidate->tempInfo();
 	PCNode::TempInfo* ctinfo;
@@ -603,7 +953,7 @@ PCNode* PCTree::createCentralNode() {
 		}
 
 		// create the new central node
-		central = newNode(PCNodeType::CNode);
+		central = newNode<Observers>(PCNodeType::CNode, nullptr, -1);
 		ctinfo = &central->tempInfo();
 		log << "New Central has index " << central->index();
 
@@ -615,20 +965,16 @@ PCNode* PCTree::createCentralNode() {
 		PCNode* fullNode = nullptr;
 		if (fullNeighbors == 1 && isParentFull) {
 			m_apexCandidate->replaceWith(central);
-			for (auto obs : m_observers) {
-				obs->nodeReplaced(*this, m_apexCandidate, central);
-			}
+			Observers::nodeReplaced(*this, m_apexCandidate, central);
 			fullNode = parent;
 			log << ", full parent is node " << parent->index();
 			OGDF_ASSERT(atinfo.fullNeighbors.front() == parent);
 		} else if (fullNeighbors > 0) {
-			fullNode = splitOffFullPNode(m_apexCandidate, isParentFull);
+			fullNode = splitOffFullPNode<Observers>(m_apexCandidate, isParentFull);
 			if (isParentFull) {
 				OGDF_ASSERT(!m_apexCandidate->isDetached());
 				m_apexCandidate->replaceWith(fullNode);
-				for (auto obs : m_observers) {
-					obs->nodeReplaced(*this, m_apexCandidate, fullNode);
-				}
+				Observers::nodeReplaced(*this, m_apexCandidate, fullNode);
 				fullNode->appendChild(central);
 			} else {
 				central->appendChild(fullNode);
@@ -664,9 +1010,7 @@ PCNode* PCTree::createCentralNode() {
 			} else {
 				emptyNode = parent;
 				m_apexCandidate->replaceWith(central);
-				for (auto obs : m_observers) {
-					obs->nodeReplaced(*this, m_apexCandidate, central);
-				}
+				Observers::nodeReplaced(*this, m_apexCandidate, central);
 				log << ", empty parent is node " << parent->index();
 			}
 		} else if (emptyNeighbors > 1) {
@@ -685,9 +1029,7 @@ PCNode* PCTree::createCentralNode() {
 			OGDF_ASSERT(m_apexCandidate->getDegree() == emptyNeighbors + 1);
 		}
 
-		for (auto obs : m_observers) {
-			obs->onApexMoved(*this, m_apexCandidate, central, parent);
-		}
+		Observers::onApexMoved(*this, m_apexCandidate, central, parent);
 
 		if (emptyNeighbors <= 1) {
 			if (m_apexCandidate == m_rootNode) {
@@ -786,6 +1128,7 @@ PCNode* PCTree::createCentralNode() {
 	return central;
 }
 
+template<typename Observers>
 int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 	int count = 0;
 	PCNode*& fullNeigh = central->getFullNeighInsertionPoint(tpNeigh);
@@ -795,15 +1138,13 @@ int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 		OGDF_ASSERT(tinfo.tpSucc != nullptr);
 		OGDF_ASSERT(tpNeigh->getLabelUnchecked() != NodeLabel::Full);
 		OGDF_ASSERT(tpNeigh->getLabelUnchecked() != NodeLabel::Unknown || tinfo.tpPred != nullptr);
-		for (auto obs : m_observers) {
-			obs->beforeMerge(*this, count, tpNeigh);
-		}
+		Observers::beforeMerge(*this, count, tpNeigh);
 		PCNode* nextTPNeigh = tinfo.tpPred;
 		PCNode* otherEndOfFullBlock;
 		if (tpNeigh->m_nodeType == PCNodeType::PNode) {
-			PC_PROFILE_ENTER(2, "update_tp_pnode");
+			PC_PROFILE_ENTER("update_tp_pnode");
 			if (tpNeigh->getLabelUnchecked() == NodeLabel::Partial) {
-				PCNode* fullNode = splitOffFullPNode(tpNeigh, false);
+				PCNode* fullNode = splitOffFullPNode<Observers>(tpNeigh, false);
 				fullNode->insertBetween(tpNeigh, fullNeigh);
 				otherEndOfFullBlock = fullNeigh = fullNode;
 				log << "\tFull child is " << fullNode << std::endl;
@@ -818,29 +1159,23 @@ int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 
 			log << "\tThere are " << tpNeigh->m_childCount << " children left" << std::endl;
 
-			for (auto obs : m_observers) {
-				obs->whenPNodeMerged(*this, tpNeigh, tinfo.tpPred, otherEndOfFullBlock);
-			}
+			Observers::whenPNodeMerged(*this, tpNeigh, tinfo.tpPred, otherEndOfFullBlock);
 
 			if (tpNeigh->m_childCount == 0) {
 				tpNeigh->detach();
-				for (auto obs : m_observers) {
-					obs->nodeDeleted(*this, tpNeigh);
-				}
+				Observers::nodeDeleted(*this, tpNeigh);
 				destroyNode(std::as_const(tpNeigh));
 			} else if (tpNeigh->m_childCount == 1) {
 				PCNode* child = tpNeigh->m_child1;
 				child->detach();
 				tpNeigh->replaceWith(child);
-				for (auto obs : m_observers) {
-					obs->nodeReplaced(*this, tpNeigh, child);
-				}
+				Observers::nodeReplaced(*this, tpNeigh, child);
 				destroyNode(std::as_const(tpNeigh));
 			}
 
-			PC_PROFILE_EXIT(2, "update_tp_pnode");
+			PC_PROFILE_EXIT("update_tp_pnode");
 		} else {
-			PC_PROFILE_ENTER(2, "update_tp_cnode");
+			PC_PROFILE_ENTER("update_tp_cnode");
 
 			auto print_tp_neigh = [](PCNode* node, int n) {
 				//                cout << n << "   node: " << node << endl << "children: " << endl;
@@ -860,6 +1195,7 @@ int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 			bool tpNeighSiblingsFlipped = false;
 			if (tpNeigh->m_sibling1 == fullNeigh || tpNeigh->m_sibling2 == otherNeigh) {
 				tpNeighSiblingsFlipped = true;
+				tpNeigh->recordState();
 				std::swap(tpNeigh->m_sibling1, tpNeigh->m_sibling2);
 			}
 			OGDF_ASSERT(tpNeigh->m_sibling1 == otherNeigh
@@ -893,10 +1229,8 @@ int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 
 			print_tp_neigh(tpNeigh, 4);
 
-			for (auto obs : m_observers) {
-				obs->whenCNodeMerged(*this, tpNeigh, tpNeighSiblingsFlipped, fullNeigh,
-						fullOuterChild);
-			}
+			Observers::whenCNodeMerged(*this, tpNeigh, tpNeighSiblingsFlipped, fullNeigh,
+					fullOuterChild);
 
 			auto parent = tpNeigh->getParent();
 
@@ -918,7 +1252,7 @@ int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 			}
 			OGDF_ASSERT(tinfo.tpPred == tinfo.ebEnd2 || tinfo.tpPred == nullptr);
 			destroyNode(std::as_const(tpNeigh));
-			PC_PROFILE_EXIT(2, "update_tp_cnode");
+			PC_PROFILE_EXIT("update_tp_cnode");
 		}
 
 		replaceTPNeigh(central, tpNeigh, nextTPNeigh, fullNeigh, otherEndOfFullBlock);
@@ -928,9 +1262,7 @@ int PCTree::updateTerminalPath(PCNode* central, PCNode* tpNeigh) {
 		auto mergedNode = tpNeigh;
 		tpNeigh = nextTPNeigh;
 		count++;
-		for (auto obs : m_observers) {
-			obs->afterMerge(*this, tpNeigh, mergedNode);
-		}
+		Observers::afterMerge(*this, tpNeigh, mergedNode);
 	}
 	return count;
 }
@@ -1062,6 +1394,7 @@ bool PCTree::setApexCandidate(PCNode* ac, bool fix) {
 
 // updateTerminalPath utils
 
+template<typename Observers>
 void PCTree::updateSingletonTerminalPath() {
 	PCNode::TempInfo& atinfo = m_apexCandidate->tempInfo();
 	OGDF_ASSERT(atinfo.tpPred == nullptr);
@@ -1070,23 +1403,20 @@ void PCTree::updateSingletonTerminalPath() {
 	int emptyNeighbors = m_apexCandidate->getDegree() - fullNeighbors;
 	if (m_apexCandidate->m_nodeType == PCNodeType::PNode && fullNeighbors > 1 && emptyNeighbors > 1) {
 		// parent is handled and degree is always greater than 1
-		PCNode* fullNode = splitOffFullPNode(m_apexCandidate, true);
+		PCNode* fullNode = splitOffFullPNode<Observers>(m_apexCandidate, true);
 		PCNode* parent = m_apexCandidate->getParent();
 		if (parent != nullptr && parent->getLabel() == NodeLabel::Full) {
 			m_apexCandidate->replaceWith(fullNode);
-			for (auto obs : m_observers) {
-				obs->nodeReplaced(*this, m_apexCandidate, fullNode);
-			}
+			Observers::nodeReplaced(*this, m_apexCandidate, fullNode);
 			fullNode->appendChild(m_apexCandidate);
-			for (auto obs : m_observers) {
-				obs->onApexMoved(*this, m_apexCandidate, fullNode, parent);
-			}
+			Observers::onApexMoved(*this, m_apexCandidate, fullNode, parent);
 		} else {
 			m_apexCandidate->appendChild(fullNode);
 		}
 	}
 }
 
+template<typename Observers>
 PCNode* PCTree::splitOffFullPNode(PCNode* node, bool skip_parent) {
 	auto& tinfo = node->tempInfo();
 	auto* parent = node->getParent();
@@ -1095,12 +1425,10 @@ PCNode* PCTree::splitOffFullPNode(PCNode* node, bool skip_parent) {
 		OGDF_ASSERT(fullNode != parent);
 		OGDF_ASSERT(node->isParentOf(fullNode));
 		fullNode->detach();
-		for (auto obs : m_observers) {
-			obs->fullNodeSplit(*this, fullNode);
-		}
+		Observers::fullNodeSplit(*this, fullNode);
 		return fullNode;
 	}
-	PCNode* fullNode = newNode(PCNodeType::PNode);
+	PCNode* fullNode = newNode<Observers>(PCNodeType::PNode, nullptr, -1);
 	fullNode->setLabel(NodeLabel::Full);
 	for (PCNode* fullChild : tinfo.fullNeighbors) {
 		if (skip_parent) {
@@ -1120,10 +1448,10 @@ PCNode* PCTree::splitOffFullPNode(PCNode* node, bool skip_parent) {
 	} else {
 		OGDF_ASSERT(fullNode->getDegree() >= 2);
 	}
-	for (auto obs : m_observers) {
-		obs->fullNodeSplit(*this, fullNode);
-	}
+	Observers::fullNodeSplit(*this, fullNode);
 	return fullNode;
 }
+template bool PCTree::makeFullNodesConsecutive<PCTree::NoObservers>();
+template bool PCTree::makeFullNodesConsecutive<PCTree::ObserverList>();
 
 }
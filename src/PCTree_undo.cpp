@@ -0,0 +1,140 @@
+/** \file
+ * \brief Implementation of checkpoints and rollbacks for pc_tree::PCTree
+ *
+ * \author Simon D. Fink <ogdf@niko.fink.bayern>
+ *
+ * \par License:
+ * This file is part of the Open Graph Drawing Framework (OGDF).
+ *
+ * \par
+ * Copyright (C)<br>
+ * See README.md in the OGDF root directory for details.
+ *
+ * \par
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * Version 2 or 3 as published by the Free Software Foundation;
+ * see the file LICENSE.txt included in the packaging of this file
+ * for details.
+ *
+ * \par
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * \par
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+#include <pctree/PCNode.h>
+#include <pctree/PCTree.h>
+#include <pctree/PCTreeForest.h>
+
+using namespace pc_tree;
+
+void PCTree::checkpoint() {
+	OGDF_ASSERT(!m_forest->isFrozen());
+	OGDF_ASSERT(m_forest->m_recordingTree == nullptr || m_forest->m_recordingTree == this);
+	m_forest->m_recordingTree = this;
+	m_forest->m_undoCheckpoints.push_back({m_forest->m_undoLog.size(), m_forest->m_nextNodeId,
+			m_rootNode, m_pNodeCount, m_cNodeCount});
+}
+
+void PCTree::rollback() {
+	using Kind = PCTreeForest::UndoRecord::Kind;
+	OGDF_ASSERT(m_forest->m_recordingTree == this);
+	OGDF_ASSERT(!m_forest->m_undoCheckpoints.empty());
+	const PCTreeForest::UndoCheckpoint cp = m_forest->m_undoCheckpoints.back();
+	m_forest->m_undoCheckpoints.pop_back();
+
+	std::vector<PCTreeForest::UndoRecord>& log = m_forest->m_undoLog;
+	OGDF_ASSERT(log.size() >= cp.m_logSize);
+	while (log.size() > cp.m_logSize) {
+		const PCTreeForest::UndoRecord& record = log.back();
+		PCNode* node = record.m_node;
+		switch (record.m_kind) {
+		case Kind::NodeState:
+			node->m_nodeListIndex = record.m_index;
+			node->m_parentCNodeId = record.m_parentCNodeId;
+			node->m_parentPNode = record.m_parentPNode;
+			node->m_sibling1 = record.m_sibling1;
+			node->m_sibling2 = record.m_sibling2;
+			node->m_child1 = record.m_child1;
+			node->m_child2 = record.m_child2;
+			node->m_childCount = record.m_childCount;
+			if (node->m_nodeType != record.m_nodeType) {
+				// don't use changeType(), which would record the change again
+				if (record.m_nodeType == PCNodeType::Leaf) {
+					node->m_userData = {};
+				} else if (node->m_nodeType == PCNodeType::Leaf) {
+					node->m_temp = nullptr;
+				}
+				node->m_nodeType = record.m_nodeType;
+			}
+			break;
+		case Kind::NodeCreated:
+			m_forest->releaseNode(node);
+			break;
+		case Kind::NodeDestroyed:
+			// the storage was kept alive, so there is nothing to do
+			break;
+		case Kind::LeafAdded:
+			m_leaves.erase(node);
+			// leaves are added at the back and removed in reverse order
+			OGDF_ASSERT(m_leavesByIndex.back() == node);
+			m_leavesByIndex.pop_back();
+			node->m_nodeListIndex = UNIONFINDINDEX_EMPTY;
+			break;
+		case Kind::LeafRemoved:
+			m_leaves.restore(node);
+			node->m_nodeListIndex = record.m_index;
+			m_leavesByIndex[record.m_index] = node;
+			break;
+		case Kind::CNodeSlot:
+			m_forest->m_cNodes[record.m_index] = node;
+			break;
+		case Kind::Link:
+			m_forest->m_parents.unlink(record.m_index);
+			break;
+		default:
+			OGDF_ASSERT(false);
+		}
+		log.pop_back();
+	}
+
+	m_forest->m_nextNodeId = cp.m_nextNodeId;
+	m_structureVersion++;
+	m_rootNode = cp.m_rootNode;
+	m_pNodeCount = cp.m_pNodeCount;
+	m_cNodeCount = cp.m_cNodeCount;
+	if (m_forest->m_undoCheckpoints.empty()) {
+		OGDF_ASSERT(log.empty());
+		m_forest->m_recordingTree = nullptr;
+	}
+	resetTempData();
+	OGDF_HEAVY_ASSERT(checkValid());
+}
+
+void PCTree::commit() {
+	OGDF_ASSERT(m_forest->m_recordingTree == this);
+	OGDF_ASSERT(!m_forest->m_undoCheckpoints.empty());
+	m_forest->m_undoCheckpoints.pop_back();
+	if (!m_forest->m_undoCheckpoints.empty()) {
+		return;
+	}
+
+	for (const PCTreeForest::UndoRecord& record : m_forest->m_undoLog) {
+		if (record.m_kind == PCTreeForest::UndoRecord::Kind::NodeDestroyed) {
+			m_forest->releaseNode(record.m_node);
+		}
+	}
+	m_forest->m_undoLog.clear();
+	m_forest->m_recordingTree = nullptr;
+}
+
+size_t PCTree::getCheckpointCount() const {
+	return m_forest->m_recordingTree == this ? m_forest->m_undoCheckpoints.size() : 0;
+}
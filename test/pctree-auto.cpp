@@ -146,14 +146,25 @@ struct CreateCentralNode {
 	void testConsecutive() {
 		T = std::make_unique<PCTree>();
 		createTree();
+		AssertThat(T->canMakeConsecutive(fullLeaves), IsTrue());
+		std::string uid = T->uniqueID(uid_utils::nodeToID);
+		T->checkpoint();
+		AssertThat(T->makeConsecutive(fullLeaves), IsTrue());
+		T->rollback();
+		AssertThat(T->checkValid(), IsTrue());
+		AssertThat(T->uniqueID(uid_utils::nodeToID), Equals(uid));
+
+		T->cachedLeafOrder();
 		bool possible = T->makeConsecutive(fullLeaves);
 		AssertThat(possible, IsTrue());
 		AssertThat(T->checkValid(), IsTrue());
 		AssertThat(T->possibleOrders<BigInt>(), Equals(orders));
+		AssertThat(T->cachedLeafOrder(), Equals(T->currentLeafOrder()));
 
 		AssertThat(T->makeConsecutive(emptyLeaves), IsTrue());
 		AssertThat(T->checkValid(), IsTrue());
 		AssertThat(T->possibleOrders<BigInt>(), Equals(orders));
+		AssertThat(T->cachedLeafOrder(), Equals(T->currentLeafOrder()));
 		T.reset(); // catch exceptions from destructor
 	}
 
@@ -31,9 +31,19 @@
 
 #include <pctree/PCNode.h>
 #include <pctree/PCTree.h>
+#include <pctree/PCTreeBatchSolver.h>
 
 #include <bandit/bandit.h>
 
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+
 using namespace pc_tree;
 using namespace snowhouse;
 using namespace bandit;
@@ -76,6 +86,20 @@ void testFromString(PCTree& tree) {
 		for (PCNode* n : dfs) {
 			AssertThat(node_labels[n], Equals(std::to_string(n->index())));
 		}
+
+		PCTree streamed(ss, nullptr, true);
+		AssertThat(tree.uniqueID(uid_utils::nodeToID), Equals(streamed.uniqueID(uid_utils::nodeToID)));
+	});
+}
+
+void testBinary(PCTree& tree) {
+	it("produces equivalent trees when constructed from the binary format", [&]() {
+		std::stringstream ss;
+		tree.writeBinary(ss);
+		std::string data = ss.str();
+		PCTree copy(reinterpret_cast<const std::byte*>(data.data()), data.size(), true);
+		AssertThat(tree.uniqueID(uid_utils::nodeToID), Equals(copy.uniqueID(uid_utils::nodeToID)));
+		AssertThat(copy.getRootNode()->index(), Equals(tree.getRootNode()->index()));
 	});
 }
 
@@ -84,6 +108,7 @@ void testCopyCtor(PCTree& tree) {
 		PCTreeNodeArray<PCNode*> map(tree);
 		PCTree copy(tree, map, true);
 		AssertThat(tree.uniqueID(uid_utils::leafToID), Equals(copy.uniqueID(uid_utils::leafToID)));
+		AssertThat(copy.canonicalHash(), Equals(tree.canonicalHash()));
 		FilteringPCTreeDFS dfs(tree, tree.getRootNode());
 		for (PCNode* n : dfs) {
 			AssertThat(map[n]->index(), Equals(n->index()));
@@ -130,6 +155,7 @@ void testIterators(PCTree& tree) {
 
 void testGeneric(PCTree& tree) {
 	testFromString(tree);
+	testBinary(tree);
 	testCopyCtor(tree);
 	testLeafOrder(tree);
 	testIterators(tree);
@@ -295,6 +321,467 @@ go_bandit([]() {
 			testGeneric(T);
 		});
 
+		it("applies batches of restrictions correctly", []() {
+			std::vector<PCNode*> leaves;
+			PCTree T(10, &leaves);
+			std::vector<size_t> offsets {0, 2, 4, 6, 9, 11, 12, 14};
+			std::vector<int> ids {0, 1, 2, 3, 1, 2, 3, 4, 5, 1, 3, 0, 6, 7};
+			std::vector<PCNode*> batch;
+			for (int i : ids) {
+				batch.push_back(leaves.at(i));
+			}
+			std::vector<size_t> failed;
+			AssertThat(T.makeConsecutiveBatch(offsets, batch, true, &failed), Equals((size_t)4));
+			AssertThat(failed, Equals(std::vector<size_t> {4}));
+
+			PCTree T2(10);
+			AssertThat(makeConsecutive(T2, {0, 1}), IsTrue());
+			AssertThat(makeConsecutive(T2, {2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T2, {1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T2, {3, 4, 5}), IsTrue());
+			AssertThat(makeConsecutive(T2, {6, 7}), IsTrue());
+			AssertThat(T.uniqueID(uid_utils::leafToID), Equals(T2.uniqueID(uid_utils::leafToID)));
+
+			leaves.clear();
+			PCTree T3(10, &leaves);
+			batch.clear();
+			for (int i : ids) {
+				batch.push_back(leaves.at(i));
+			}
+			AssertThat(T3.makeConsecutiveBatch(offsets, batch), Equals((size_t)4));
+			AssertThat(T3.makeConsecutiveBatch({0, 2}, {leaves.at(6), leaves.at(7)}), Equals((size_t)1));
+			AssertThat(T.uniqueID(uid_utils::leafToID), Equals(T3.uniqueID(uid_utils::leafToID)));
+
+			testGeneric(T);
+		});
+
+		it("applies restrictions given by leaf IDs or bitsets", []() {
+			std::vector<PCNode*> leaves;
+			PCTree T(70, &leaves);
+			for (size_t i = 0; i < leaves.size(); ++i) {
+				AssertThat(leaves[i]->getLeafIndex(), Equals(i));
+				AssertThat(T.getLeafByIndex(i), Equals(leaves[i]));
+			}
+			AssertThat(T.getLeafByIndex(70), Equals((PCNode*)nullptr));
+
+			PCTree T2(70);
+			PCTree T3(70);
+			// leaf indices are independent of the IDs of the forest
+			T3.getForest()->compact();
+			std::vector<std::vector<size_t>> restrictions {
+					{1, 2}, {3, 4}, {2, 3}, {4, 5, 6}, {63, 64, 65, 66}, {2, 4}, {62, 63}};
+			for (const std::vector<size_t>& ids : restrictions) {
+				std::vector<PCNode*> restriction;
+				for (size_t id : ids) {
+					restriction.push_back(leaves.at(id));
+				}
+				bool expected = T.makeConsecutive(restriction);
+				AssertThat(T2.makeConsecutiveByLeafIndex(ids), Equals(expected));
+				std::vector<uint64_t> bits(2, 0);
+				for (size_t id : ids) {
+					bits[id / 64] |= uint64_t(1) << (id % 64);
+				}
+				AssertThat(T3.makeConsecutiveBitset(bits), Equals(expected));
+			}
+			AssertThat(T2.uniqueID(uid_utils::leafToID), Equals(T.uniqueID(uid_utils::leafToID)));
+			AssertThat(T3.uniqueID(uid_utils::leafToID), Equals(T.uniqueID(uid_utils::leafToID)));
+
+			// indices that don't belong to leaves of the tree are rejected without changing it
+			std::string before = T2.uniqueID(uid_utils::leafToID);
+			std::vector<uint64_t> bits {0b11, uint64_t(1) << 6};
+			std::vector<size_t> invalid {0, 1, 70};
+			for (int i = 0; i < 2; ++i) {
+				bool thrown = false;
+				try {
+					if (i == 0) {
+						T2.makeConsecutiveByLeafIndex(invalid);
+					} else {
+						T2.makeConsecutiveBitset(bits);
+					}
+				} catch (const std::invalid_argument&) {
+					thrown = true;
+				}
+				AssertThat(thrown, IsTrue());
+			}
+			AssertThat(T2.uniqueID(uid_utils::leafToID), Equals(before));
+			PCNode* replaced = T2.getLeafByIndex(3);
+			T2.replaceLeaf(2, replaced);
+			AssertThat(T2.getLeafByIndex(3), Equals((PCNode*)nullptr));
+			AssertThat(T2.getLeafByIndex(71)->getLeafIndex(), Equals((size_t)71));
+
+			testGeneric(T2);
+			testGeneric(T3);
+		});
+
+		it("computes a canonical hash independent of root and child order", []() {
+			std::vector<PCNode*> leaves;
+			PCTree T(12, &leaves);
+			AssertThat(makeConsecutive(T, {0, 1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T, {5, 6, 7, 8}), IsTrue());
+			uint64_t hash = T.canonicalHash();
+
+			PCTree T2(12);
+			AssertThat(makeConsecutive(T2, {8, 7, 6, 5}), IsTrue());
+			AssertThat(makeConsecutive(T2, {2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T2, {1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T2, {0, 1}), IsTrue());
+			AssertThat(T2.uniqueID(uid_utils::leafToID), Equals(T.uniqueID(uid_utils::leafToID)));
+			AssertThat(T2.canonicalHash(), Equals(hash));
+
+			T.firstEmbedding();
+			AssertThat(T.canonicalHash(), Equals(hash));
+			T.changeRoot(leaves.at(4));
+			AssertThat(T.canonicalHash(), Equals(hash));
+
+			AssertThat(makeConsecutive(T2, {5, 6}), IsTrue());
+			AssertThat(T2.canonicalHash(), !Equals(hash));
+			PCTree T3(12);
+			AssertThat(T3.canonicalHash(), !Equals(hash));
+			AssertThat(T3.canonicalHash(), !Equals(PCTree(11).canonicalHash()));
+		});
+
+		it("computes a canonical hash independent of node IDs", []() {
+			PCTreeForest forest;
+			delete new PCTree(20, nullptr, &forest);
+			PCTree T(12, nullptr, &forest);
+			PCTree T2(12);
+			for (PCTree* tree : {&T, &T2}) {
+				AssertThat(makeConsecutive(*tree, {0, 1, 2}), IsTrue());
+				AssertThat(makeConsecutive(*tree, {5, 6, 7, 8}), IsTrue());
+			}
+			AssertThat(T.getLeaves().front()->index(), !Equals(T2.getLeaves().front()->index()));
+			uint64_t hash = T2.canonicalHash();
+			AssertThat(T.canonicalHash(), Equals(hash));
+			forest.compact();
+			AssertThat(T.canonicalHash(), Equals(hash));
+		});
+
+		it("maintains the cached leaf order", []() {
+			std::vector<PCNode*> leaves;
+			PCTree T(20, &leaves);
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+			std::mt19937 gen(7);
+			std::uniform_int_distribution<int> dist(0, 19);
+			for (int i = 0; i < 50; ++i) {
+				int start = dist(gen);
+				std::vector<PCNode*> restriction;
+				for (int j = 0; j < 2 + i % 4; ++j) {
+					restriction.push_back(leaves.at((start + j) % 20));
+				}
+				T.makeConsecutive(restriction);
+				const std::vector<PCNode*>& order = T.cachedLeafOrder();
+				AssertThat(order, Equals(T.currentLeafOrder()));
+				for (size_t p = 0; p < order.size(); ++p) {
+					AssertThat(T.getLeafPosition(order[p]), Equals(p));
+				}
+			}
+			T.changeRoot(leaves.at(3));
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+			T.clearLeafOrderCache();
+			AssertThat(makeConsecutive(T, {0, 1}), IsTrue());
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+		});
+
+		it("keeps the cached leaf order of other trees in the same forest", []() {
+			PCTreeForest forest;
+			std::vector<PCNode*> leaves, otherLeaves;
+			PCTree T(10, &leaves, &forest);
+			PCTree U(10, &otherLeaves, &forest);
+			AssertThat(makeConsecutive(T, {0, 1, 2}), IsTrue());
+			std::vector<PCNode*> before = T.cachedLeafOrder();
+			AssertThat(makeConsecutive(U, {0, 1}), IsTrue());
+			U.changeRoot(otherLeaves.at(5));
+			U.replaceLeaf(3, otherLeaves.at(7));
+			AssertThat(T.cachedLeafOrder(), Equals(before));
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+
+			AssertThat(makeConsecutive(T, {1, 2, 3}), IsTrue());
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+			// direct changes to nodes can't be attributed to a tree and invalidate all orders
+			leaves.at(5)->getParent()->flip();
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+			AssertThat(T.cachedLeafOrder(), !Equals(before));
+		});
+
+		it("checks restrictions without applying them", []() {
+			std::vector<PCNode*> leaves;
+			PCTree T(10, &leaves);
+			AssertThat(makeConsecutive(T, {0, 1}), IsTrue());
+			AssertThat(makeConsecutive(T, {2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T, {1, 2}), IsTrue());
+			std::string before = T.uniqueID(uid_utils::leafToID);
+
+			AssertThat(T.canMakeConsecutive({leaves.at(3), leaves.at(4)}), IsTrue());
+			AssertThat(T.canMakeConsecutive({leaves.at(1), leaves.at(3)}), IsFalse());
+			AssertThat(T.canMakeConsecutive({leaves.at(0), leaves.at(2)}), IsFalse());
+			AssertThat(T.canMakeConsecutive({leaves.at(5), leaves.at(7), leaves.at(9)}), IsTrue());
+			AssertThat(T.canMakeConsecutive({leaves.at(0)}), IsTrue());
+			AssertThat(T.uniqueID(uid_utils::leafToID), Equals(before));
+
+			AssertThat(T.makeConsecutive({leaves.at(1), leaves.at(3)}), IsFalse());
+			AssertThat(T.makeConsecutive({leaves.at(3), leaves.at(4)}), IsTrue());
+			AssertThat(T.uniqueID(uid_utils::leafToID), !Equals(before));
+		});
+
+		it("applies the same restrictions with and without observers", []() {
+			struct CountingObserver : public PCTree::Observer {
+				int created = 0;
+				int done = 0;
+				int successful = 0;
+
+				void onNodeCreate(PCNode*) override { created++; }
+
+				void makeConsecutiveDone(PCTree&, Stage, bool success) override {
+					done++;
+					if (success) {
+						successful++;
+					}
+				}
+			};
+
+			PCTree observed(10);
+			PCTree unobserved(10);
+			CountingObserver observer;
+			observed.addObserver(&observer);
+			AssertThat(observed.hasObservers(), IsTrue());
+			AssertThat(unobserved.hasObservers(), IsFalse());
+			for (PCTree* T : {&observed, &unobserved}) {
+				AssertThat(makeConsecutive(*T, {0, 1}), IsTrue());
+				AssertThat(makeConsecutive(*T, {2, 3}), IsTrue());
+				AssertThat(makeConsecutive(*T, {1, 2}), IsTrue());
+				AssertThat(makeConsecutive(*T, {1, 3}), IsFalse());
+				AssertThat(makeConsecutive(*T, {4}), IsTrue());
+			}
+			AssertThat(observed.uniqueID(uid_utils::leafToID),
+					Equals(unobserved.uniqueID(uid_utils::leafToID)));
+			AssertThat(observer.done, Equals(5));
+			AssertThat(observer.successful, Equals(4));
+			AssertThat(observer.created, IsGreaterThan(0));
+
+			observed.removeObserver(&observer);
+			AssertThat(observed.hasObservers(), IsFalse());
+			AssertThat(makeConsecutive(observed, {5, 6}), IsTrue());
+			AssertThat(observer.done, Equals(5));
+		});
+
+		it("reverts changes to a checkpoint", []() {
+			PCTree T(20);
+			AssertThat(makeConsecutive(T, {0, 1, 2, 3, 4, 5, 6, 7}), IsTrue());
+			AssertThat(makeConsecutive(T, {10, 11, 12, 13}), IsTrue());
+			std::string uid0 = T.uniqueID(uid_utils::nodeToID);
+			size_t nodes0 = T.getNodeCount();
+
+			T.checkpoint();
+			AssertThat(makeConsecutive(T, {2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T, {3, 4}), IsTrue());
+			AssertThat(makeConsecutive(T, {7, 10}), IsTrue());
+			AssertThat(makeConsecutive(T, {4, 5, 6, 7, 10, 11}), IsTrue());
+			std::string uid1 = T.uniqueID(uid_utils::nodeToID);
+
+			T.checkpoint();
+			AssertThat(T.getCheckpointCount(), Equals((size_t)2));
+			AssertThat(makeConsecutive(T, {14, 15}), IsTrue());
+			AssertThat(makeConsecutive(T, {0, 1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {1, 3}), IsFalse());
+			AssertThat(T.uniqueID(uid_utils::nodeToID), !Equals(uid1));
+			T.rollback();
+			AssertThat(T.checkValid(), IsTrue());
+			AssertThat(T.uniqueID(uid_utils::nodeToID), Equals(uid1));
+
+			T.rollback();
+			AssertThat(T.getCheckpointCount(), Equals((size_t)0));
+			AssertThat(T.checkValid(), IsTrue());
+			AssertThat(T.uniqueID(uid_utils::nodeToID), Equals(uid0));
+			AssertThat(T.getNodeCount(), Equals(nodes0));
+
+			T.checkpoint();
+			AssertThat(makeConsecutive(T, {7, 10}), IsTrue());
+			std::string uid2 = T.uniqueID(uid_utils::leafToID);
+			T.commit();
+			AssertThat(T.getCheckpointCount(), Equals((size_t)0));
+			AssertThat(T.uniqueID(uid_utils::leafToID), Equals(uid2));
+
+			testGeneric(T);
+		});
+
+		it("records phase timings in its forest", []() {
+			PCTreeForest forest;
+			std::vector<PCNode*> added;
+			PCTree T(10, &added, &forest);
+			AssertThat(makeConsecutive(T, {0, 1}), IsTrue());
+			AssertThat(makeConsecutive(T, {2, 3, 4}), IsTrue());
+			AssertThat(makeConsecutive(T, {1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {0, 3}), IsFalse());
+
+			const PCTreeProfile& profile = forest.getProfile();
+			using Phase = PCTreeProfile::Phase;
+			uint64_t expected = PCTreeProfile::enabled ? 4 : 0;
+			AssertThat(profile[Phase::MarkFull].calls, Equals(expected));
+			AssertThat(profile[Phase::FindTerminalPath].calls, Equals(expected));
+			AssertThat(profile[Phase::CreateCentralNode].calls + profile[Phase::UpdateTerminalPath].calls,
+					IsGreaterThanOrEqualTo(expected / 2));
+			forest.resetProfile();
+			AssertThat(profile[Phase::MarkFull].calls, Equals((uint64_t)0));
+			AssertThat(profile.totalTime().count(), Equals(0));
+		});
+
+		it("reuses node storage of its forest", []() {
+			PCTreeForest forest;
+			forest.reserveNodes(11);
+			size_t capacity = forest.getNodeCapacity();
+			AssertThat(capacity, IsGreaterThanOrEqualTo((size_t)11));
+			PCTree* T = forest.makeTree();
+			PCNode* root = T->newNode(PCNodeType::PNode);
+			std::vector<PCNode*> leaves;
+			T->insertLeaves(10, root, &leaves);
+			AssertThat(forest.getNodeCapacity(), Equals(capacity));
+			AssertThat(root->index(), Equals((size_t)0));
+			AssertThat(forest.getNode(0), Equals(root));
+			for (size_t i = 0; i < leaves.size(); ++i) {
+				AssertThat(leaves[i]->index(), Equals(i + 1));
+				AssertThat(forest.getNode(i + 1), Equals(leaves[i]));
+			}
+			AssertThat(T->makeConsecutive({leaves[3], leaves[4]}), IsTrue());
+
+			capacity = forest.getNodeCapacity();
+			const PCTreeRegistry& registry = forest;
+			int arraySize = registry.getArraySize();
+			forest.clear();
+			AssertThat(forest.getNode(0), Equals((PCNode*)nullptr));
+			PCTree* T2 = forest.makeTree();
+			PCNode* root2 = T2->newNode(PCNodeType::CNode);
+			std::vector<PCNode*> leaves2;
+			T2->insertLeaves(10, root2, &leaves2);
+			AssertThat(root2->index(), Equals((size_t)0));
+			AssertThat(forest.getNode(10), Equals(leaves2.back()));
+			// the storage and arrays of the cleared tree are reused
+			AssertThat(forest.getNodeCapacity(), Equals(capacity));
+			AssertThat(registry.getArraySize(), Equals(arraySize));
+		});
+
+		it("inserts many leaves at once", []() {
+			PCTreeForest forest;
+			PCTree* T = forest.makeTree();
+			PCTreeNodeArray<int> marks(*T, 7);
+			PCNode* root = T->newNode(PCNodeType::PNode);
+			std::vector<PCNode*> leaves;
+			T->insertLeaves(100000, root, &leaves);
+			AssertThat(T->getLeafCount(), Equals((size_t)100000));
+			AssertThat(root->getChildCount(), Equals((size_t)100000));
+			AssertThat(T->checkValid(), IsTrue());
+			size_t i = 0;
+			for (PCNode* child : root->children()) {
+				AssertThat(child, Equals(leaves[i]));
+				AssertThat(child->index(), Equals(i + 1));
+				AssertThat(marks[child], Equals(7));
+				i++;
+			}
+
+			AssertThat(T->makeConsecutive({leaves[1], leaves[2], leaves[3]}), IsTrue());
+			AssertThat(T->makeConsecutive({leaves[2], leaves[3], leaves[4]}), IsTrue());
+			PCNode* cNode = leaves[1]->getParent();
+			AssertThat(cNode->getNodeType(), Equals(PCNodeType::CNode));
+			size_t childCount = cNode->getChildCount();
+			T->checkpoint();
+			std::vector<PCNode*> added;
+			T->insertLeaves(3, cNode, &added);
+			AssertThat(cNode->getChildCount(), Equals(childCount + 3));
+			AssertThat(cNode->getChild2(), Equals(added.back()));
+			AssertThat(T->checkValid(), IsTrue());
+			T->rollback();
+			AssertThat(cNode->getChildCount(), Equals(childCount));
+			AssertThat(T->getLeafCount(), Equals((size_t)100000));
+			AssertThat(T->checkValid(), IsTrue());
+		});
+
+		it("maintains sets of nodes", []() {
+			std::vector<PCNode*> leaves;
+			PCTree T(10, &leaves);
+			PCTreeNodeSet<> set(T);
+			for (int i : {2, 4, 6, 8}) {
+				set.insert(leaves[i]);
+			}
+			set.insert(leaves[4]);
+			AssertThat(set.size(), Equals(4));
+			AssertThat(set.remove(leaves[2]), IsTrue());
+			AssertThat(set.remove(leaves[2]), IsFalse());
+			AssertThat(set.isMember(leaves[2]), IsFalse());
+			AssertThat(set.isMember(leaves[8]), IsTrue());
+
+			std::vector<PCNode*> added;
+			T.insertLeaves(100, T.getRootNode(), &added);
+			set.insert(added.back());
+			std::set<PCNode*> members(set.begin(), set.end());
+			std::set<PCNode*> expected {leaves[4], leaves[6], leaves[8], added.back()};
+			AssertThat(members == expected, IsTrue());
+			for (PCNode* leaf : leaves) {
+				AssertThat(set(leaf), Equals(members.count(leaf) > 0));
+			}
+
+			set.clear();
+			AssertThat(set.size(), Equals(0));
+			AssertThat(set.isMember(added.back()), IsFalse());
+			set.insert(leaves[0]);
+			AssertThat(set.elements().size(), Equals((size_t)1));
+			AssertThat(set.elements().front(), Equals(leaves[0]));
+		});
+
+		it("compacts the IDs of its forest", []() {
+			PCTreeForest forest;
+			std::vector<PCNode*> leaves;
+			PCTree T(20, &leaves, &forest);
+			for (int i = 0; i < 10; i++) {
+				PCNode* leaf = leaves[i];
+				T.makeConsecutive({leaves[i], leaves[i + 1]});
+				T.makeConsecutive({leaves[i], leaves[i + 1], leaves[i + 2]});
+				T.replaceLeaf(3, leaf, &leaves);
+				T.destroyLeaf(leaves.back());
+				leaves.pop_back();
+				leaves[i] = leaves.back();
+				leaves.pop_back();
+			}
+			AssertThat(T.checkValid(), IsTrue());
+			size_t maxIndex = 0;
+			for (PCNode* node : T.allNodes()) {
+				maxIndex = std::max(maxIndex, node->index());
+			}
+			AssertThat(maxIndex, IsGreaterThan(T.getNodeCount()));
+
+			PCTreeNodeArray<std::string> labels(T);
+			for (PCNode* node : T.allNodes()) {
+				labels[node] = std::to_string(node->index());
+			}
+			auto printLabel = [&](std::ostream& os, PCNode* n, int) {
+				if (n->isLeaf()) {
+					os << labels[n];
+				}
+			};
+			std::string before = T.uniqueID(printLabel);
+			size_t nodes = T.getNodeCount();
+			T.cachedLeafOrder();
+			forest.compact();
+			AssertThat(T.checkValid(), IsTrue());
+			AssertThat(T.cachedLeafOrder(), Equals(T.currentLeafOrder()));
+			AssertThat(T.getNodeCount(), Equals(nodes));
+			for (PCNode* node : T.allNodes()) {
+				AssertThat(node->index(), IsLessThan(nodes));
+				AssertThat(forest.getNode(node->index()), Equals(node));
+			}
+			AssertThat(forest.getNode(nodes), Equals((PCNode*)nullptr));
+			AssertThat(T.uniqueID(printLabel), Equals(before));
+
+			PCTreeNodeArray<int> marks(T, 0);
+			std::vector<PCNode*> added;
+			T.insertLeaves(2, leaves[15]->getParent(), &added);
+			AssertThat(added[0]->index(), Equals(nodes));
+			AssertThat(labels[added[0]], Equals(""));
+			AssertThat(marks[added[1]], Equals(0));
+			AssertThat(T.makeConsecutive({leaves[12], leaves[13], added[0]}), IsTrue());
+			AssertThat(T.checkValid(), IsTrue());
+		});
+
 		it("applies bigger restrictions correctly", []() {
 			PCTree T(50);
 			AssertThat(
@@ -346,6 +833,304 @@ go_bandit([]() {
 			testGeneric(T);
 		});
 
+		it("detects validity of all permutations", []() {
+			PCTree T(7);
+			AssertThat(makeConsecutive(T, {0, 1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T, {4, 5}), IsTrue());
+
+			std::vector<PCNode*> leaves(T.getLeaves().begin(), T.getLeaves().end());
+			std::sort(leaves.begin(), leaves.end());
+			size_t valid = 0;
+			do {
+				if (T.isValidOrder(leaves)) {
+					valid++;
+				}
+			} while (std::next_permutation(leaves.begin(), leaves.end()));
+			AssertThat(valid, Equals(T.getLeafCount() * T.possibleOrders<size_t>()));
+		});
+
+		it("answers read-only queries concurrently while frozen", []() {
+			PCTreeForest forest;
+			PCTree T("0:[1:(2, 3, 4), 5, 6:[7, 8, 9], 10:(11, 12:[13, 14, 15], 16)]", nullptr, true,
+					&forest);
+			AssertThat(makeConsecutive(T, {0, 1, 2, 3}), IsTrue());
+			AssertThat(makeConsecutive(T, {4, 5, 6}), IsTrue());
+			std::string expected = T.uniqueID(uid_utils::nodeToID);
+			std::vector<PCNode*> expectedOrder = T.currentLeafOrder();
+			size_t expectedOrders = T.possibleOrders<size_t>();
+
+			const PCTreeRegistry& registry = forest;
+			AssertThat(registry.isConcurrent(), IsFalse());
+			forest.freeze();
+			AssertThat(forest.isFrozen(), IsTrue());
+			AssertThat(registry.isConcurrent(), IsTrue());
+			std::vector<int> correct(4, 0);
+			std::vector<std::thread> threads;
+			for (size_t t = 0; t < correct.size(); t++) {
+				threads.emplace_back([&, t]() {
+					for (int i = 0; i < 50; i++) {
+						if (T.uniqueID(uid_utils::nodeToID) == expected
+								&& T.currentLeafOrder() == expectedOrder
+								&& T.possibleOrders<size_t>() == expectedOrders
+								&& T.isValidOrder(expectedOrder)) {
+							correct[t]++;
+						}
+					}
+				});
+			}
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+			for (int c : correct) {
+				AssertThat(c, Equals(50));
+			}
+
+			forest.unfreeze();
+			AssertThat(registry.isConcurrent(), IsFalse());
+			AssertThat(makeConsecutive(T, {7, 8}), IsTrue());
+		});
+
+		it("updates trees of different forests in parallel and merges them", []() {
+			std::vector<std::unique_ptr<PCTreeForest>> forests;
+			std::vector<PCTree*> trees;
+			for (int t = 0; t < 4; t++) {
+				forests.emplace_back(new PCTreeForest(false));
+				trees.push_back(new PCTree(6, nullptr, forests.back().get()));
+			}
+			std::vector<std::thread> threads;
+			std::vector<int> success(trees.size(), 0);
+			for (size_t t = 0; t < trees.size(); t++) {
+				threads.emplace_back([&, t]() {
+					success[t] = makeConsecutive(*trees[t], {0, 1}) && makeConsecutive(*trees[t], {1, 2})
+							&& makeConsecutive(*trees[t], {3, 4, 5});
+				});
+			}
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+
+			PCTree T(3);
+			for (size_t t = 0; t < trees.size(); t++) {
+				AssertThat(success[t], Equals(1));
+				T.insertTree(*T.getLeaves().begin(), trees[t]);
+				AssertThat(T.checkValid(), IsTrue());
+			}
+
+			// compare with doing the same sequentially within a single forest
+			PCTree reference(3);
+			for (size_t t = 0; t < trees.size(); t++) {
+				PCTree* tree = new PCTree(6, nullptr, reference.getForest());
+				AssertThat(makeConsecutive(*tree, {0, 1}) && makeConsecutive(*tree, {1, 2})
+								&& makeConsecutive(*tree, {3, 4, 5}),
+						IsTrue());
+				reference.insertTree(*reference.getLeaves().begin(), tree);
+			}
+			AssertThat(T.possibleOrders<size_t>(), Equals(reference.possibleOrders<size_t>()));
+			AssertThat(T.getLeafCount(), Equals((size_t)(3 + 4 * 5)));
+		});
+
+		it("maps the nodes of trees inserted from other forests", []() {
+			for (bool sameForest : {false, true}) {
+				PCTree T(3);
+				std::vector<PCNode*> leaves;
+				PCTree* inserted = new PCTree(5, &leaves, sameForest ? T.getForest() : nullptr);
+				AssertThat(inserted->makeConsecutive({leaves[0], leaves[1]}), IsTrue());
+				std::vector<size_t> leafIDs;
+				for (PCNode* leaf : leaves) {
+					leafIDs.push_back(leaf->index());
+				}
+				size_t rootID = inserted->getRootNode()->index();
+
+				std::vector<PCNode*> mapping;
+				T.insertTree(*T.getLeaves().begin(), inserted, &mapping);
+				AssertThat(T.checkValid(), IsTrue());
+				AssertThat(T.getLeafCount(), Equals((size_t)7));
+				std::set<PCNode*> mappedLeaves;
+				for (size_t id : leafIDs) {
+					PCNode* leaf = mapping.at(id);
+					AssertThat(leaf->isLeaf(), IsTrue());
+					AssertThat(leaf->getForest(), Equals(T.getForest()));
+					mappedLeaves.insert(leaf);
+				}
+				AssertThat(mappedLeaves.size(), Equals((size_t)5));
+				AssertThat(mapping.at(rootID)->getChildCount(), Equals((size_t)4));
+				AssertThat(mapping.at(leafIDs[0])->getParent()->getParent(),
+						Equals(mapping.at(rootID)));
+			}
+		});
+
+		it("solves batches of instances in parallel", []() {
+			std::mt19937 rng(42);
+			std::vector<C1PInstance> instances(500);
+			for (C1PInstance& instance : instances) {
+				instance.leafCount = std::uniform_int_distribution<int>(1, 12)(rng);
+				std::vector<int> leaves(instance.leafCount);
+				std::iota(leaves.begin(), leaves.end(), 0);
+				for (int r = 0; r < 4; r++) {
+					std::shuffle(leaves.begin(), leaves.end(), rng);
+					int size = std::uniform_int_distribution<int>(0, instance.leafCount)(rng);
+					instance.addRestriction(std::vector<int>(leaves.begin(), leaves.begin() + size));
+				}
+			}
+
+			PCTreeBatchSolver solver(4, 8);
+			std::vector<C1PResult> results = solver.solve(instances, true);
+			AssertThat(results.size(), Equals(instances.size()));
+			for (size_t i = 0; i < instances.size(); i++) {
+				const C1PInstance& instance = instances[i];
+				size_t expected = instance.getRestrictionCount();
+				if (instance.leafCount >= 3) {
+					std::vector<PCNode*> leaves;
+					PCTree T(instance.leafCount, &leaves);
+					std::vector<PCNode*> restrictionLeaves;
+					for (int leaf : instance.leaves) {
+						restrictionLeaves.push_back(leaves[leaf]);
+					}
+					expected = T.makeConsecutiveBatch(instance.offsets, restrictionLeaves);
+				}
+				AssertThat(results[i].firstFailed, Equals(expected));
+				if (!results[i].isConsecutive(instance)) {
+					AssertThat(results[i].order.empty(), IsTrue());
+					continue;
+				}
+
+				// every restriction is a cyclic interval of the returned order
+				AssertThat(results[i].order.size(), Equals((size_t)instance.leafCount));
+				std::vector<size_t> position(instance.leafCount);
+				for (size_t p = 0; p < results[i].order.size(); p++) {
+					position.at(results[i].order[p]) = p;
+				}
+				for (size_t r = 0; r < instance.getRestrictionCount(); r++) {
+					std::vector<bool> contained(instance.leafCount, false);
+					for (size_t l = instance.offsets[r]; l < instance.offsets[r + 1]; l++) {
+						contained[position[instance.leaves[l]]] = true;
+					}
+					int changes = 0;
+					for (int p = 0; p < instance.leafCount; p++) {
+						changes += contained[p] != contained[(p + 1) % instance.leafCount];
+					}
+					AssertThat(changes, IsLessThanOrEqualTo(2));
+				}
+			}
+
+			instances[123].leaves.push_back(instances[123].leafCount);
+			instances[123].offsets.push_back(instances[123].leaves.size());
+			bool thrown = false;
+			try {
+				solver.solve(instances);
+			} catch (const std::invalid_argument&) {
+				thrown = true;
+			}
+			AssertThat(thrown, IsTrue());
+
+			// the same leaf in different restrictions is fine, but not twice in one
+			instances.resize(1);
+			instances[0] = C1PInstance();
+			instances[0].leafCount = 5;
+			instances[0].addRestriction({1, 2});
+			instances[0].addRestriction({2, 3});
+			AssertThat(solver.solve(instances)[0].firstFailed, Equals((size_t)2));
+			instances[0].addRestriction({3, 4, 3});
+			thrown = false;
+			try {
+				solver.solve(instances);
+			} catch (const std::invalid_argument&) {
+				thrown = true;
+			}
+			AssertThat(thrown, IsTrue());
+		});
+
+		it("keeps IDs that are used after being generated for unlabeled nodes", []() {
+			PCTree T("(0, 1, [2, 3, 4], 5)", nullptr, true);
+			AssertThat(T.getNodeCount(), Equals((size_t)8));
+			std::vector<bool> seen(T.getNodeCount() + 2);
+			for (PCNode* node : T.allNodes()) {
+				AssertThat(seen.at(node->index()), IsFalse());
+				seen.at(node->index()) = true;
+			}
+			AssertThat(T.uniqueID(uid_utils::leafToID), Equals(T.uniqueID(uid_utils::leafToPosition)));
+
+			bool thrown = false;
+			try {
+				PCTree invalid("(0, 1, a, 3)", nullptr, true);
+			} catch (const std::invalid_argument&) {
+				thrown = true;
+			}
+			AssertThat(thrown, IsTrue());
+		});
+
+		it("loads the binary format from a file and rejects invalid data", []() {
+			PCTree T(7);
+			AssertThat(makeConsecutive(T, {0, 1, 2}), IsTrue());
+			AssertThat(makeConsecutive(T, {1, 2, 3}), IsTrue());
+
+			std::string path =
+					(std::filesystem::temp_directory_path() / "pctree-binary-test.bin").string();
+			{
+				std::ofstream out(path, std::ios::binary);
+				T.writeBinary(out);
+			}
+			std::unique_ptr<PCTree> loaded = PCTree::loadBinary(path, true);
+			std::remove(path.c_str());
+			AssertThat(loaded->uniqueID(uid_utils::leafToID), Equals(T.uniqueID(uid_utils::leafToID)));
+			AssertThat(loaded->possibleOrders<size_t>(), Equals(T.possibleOrders<size_t>()));
+
+			std::stringstream ss;
+			T.writeBinary(ss);
+			std::string data = ss.str();
+			for (size_t size : {(size_t)0, (size_t)10, data.size() - 1}) {
+				bool thrown = false;
+				try {
+					PCTree invalid(reinterpret_cast<const std::byte*>(data.data()), size);
+				} catch (const std::invalid_argument&) {
+					thrown = true;
+				}
+				AssertThat(thrown, IsTrue());
+			}
+
+			// encodes a tree in the binary format, given the parent position and type of each node
+			auto encode = [](const std::vector<uint32_t>& parents,
+								  const std::vector<uint8_t>& types) {
+				std::vector<uint32_t> ids(parents.size());
+				std::iota(ids.begin(), ids.end(), 0);
+				struct {
+					uint32_t magic = 0x42544350, version = 1;
+					uint64_t count;
+				} header;
+				header.count = parents.size();
+				std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+				data.append(reinterpret_cast<const char*>(ids.data()),
+						ids.size() * sizeof(uint32_t));
+				data.append(reinterpret_cast<const char*>(parents.data()),
+						parents.size() * sizeof(uint32_t));
+				data.append(reinterpret_cast<const char*>(types.data()), types.size());
+				return data;
+			};
+			auto loads = [](const std::string& data) {
+				try {
+					PCTree T(reinterpret_cast<const std::byte*>(data.data()), data.size());
+					return true;
+				} catch (const std::invalid_argument&) {
+					return false;
+				}
+			};
+			const uint32_t none = UINT32_MAX;
+			// a P-node with three leaves
+			AssertThat(loads(encode({none, 0, 0, 0}, {0, 2, 2, 2})), IsTrue());
+			// a C-node with only two neighbors
+			AssertThat(loads(encode({none, 0, 0, 0, 0, 4}, {0, 2, 2, 2, 1, 2})), IsFalse());
+			// an inner node without children
+			AssertThat(loads(encode({none, 0, 0, 0, 0}, {0, 2, 2, 2, 0})), IsFalse());
+			// a leaf root with more than one child
+			AssertThat(loads(encode({none, 0, 0, 0}, {2, 2, 2, 2})), IsFalse());
+			// a leaf with a child
+			AssertThat(loads(encode({none, 0, 0, 0, 1}, {0, 2, 2, 2, 2})), IsFalse());
+			// two inner nodes with only two leaves
+			AssertThat(loads(encode({none, 0, 1, 1}, {0, 0, 2, 2})), IsFalse());
+		});
+
 		it("correctly applies restrictions on manually constructed trees", []() {
 			PCTree T;
 			auto root = T.newNode(PCNodeType::CNode);
@@ -399,6 +1184,25 @@ go_bandit([]() {
 			testGeneric(T);
 		});
 
+		it("keeps the leaf indices of intersected trees", []() {
+			std::vector<PCNode*> leaves, otherLeaves;
+			PCTree A(8, &leaves);
+			PCTree B(8, &otherLeaves);
+			PCTreeNodeArray<PCNode*> leafMap(B);
+			for (size_t i = 0; i < leaves.size(); ++i) {
+				leafMap[otherLeaves[i]] = leaves[i];
+			}
+			AssertThat(B.makeConsecutive({otherLeaves[1], otherLeaves[2]}), IsTrue());
+			AssertThat(B.makeConsecutive({otherLeaves[4], otherLeaves[5], otherLeaves[6]}), IsTrue());
+			AssertThat(A.intersect(B, leafMap), IsTrue());
+			for (size_t i = 0; i < leaves.size(); ++i) {
+				AssertThat(leaves[i]->getLeafIndex(), Equals(i));
+				AssertThat(A.getLeafByIndex(i), Equals(leaves[i]));
+			}
+			AssertThat(A.makeConsecutiveByLeafIndex({0, 1}), IsTrue());
+			AssertThat(A.checkValid(), IsTrue());
+		});
+
 		describe("intersection", []() {
 			it("correctly handles the trivial case", []() {
 				testIntersection(10, {{0, 1, 2}}, {});
@@ -423,6 +1227,29 @@ go_bandit([]() {
 			it("correctly handles an impossible intersection", []() {
 				testIntersection(10, {{0, 1}, {1, 2}, {2, 3}}, {{0, 2}});
 			});
+			it("reuses its scratch space for repeated intersections", []() {
+				PCTreeForest forest;
+				std::vector<PCNode*> leaves;
+				PCTree t1(10, &leaves, &forest);
+				PCTree check(10);
+				auto intersectWith =
+						[&](std::initializer_list<std::initializer_list<int>> restrictions) {
+							PCTree t2(10);
+							PCTreeNodeArray<PCNode*> mapLeaves(t2);
+							auto it = leaves.begin();
+							for (PCNode* leaf : t2.getLeaves()) {
+								mapLeaves[leaf] = *it++;
+							}
+							AssertThat(applyRestrictions(t2, restrictions), IsTrue());
+							AssertThat(applyRestrictions(check, restrictions), IsTrue());
+							AssertThat(t1.intersect(t2, mapLeaves), IsTrue());
+							AssertThat(t1.uniqueID(uid_utils::leafToID),
+									Equals(check.uniqueID(uid_utils::leafToID)));
+						};
+				intersectWith({{0, 1}, {1, 2}, {2, 3}});
+				intersectWith({{5, 6, 7}, {7, 8, 9}});
+				intersectWith({{3, 4, 5}, {9, 0}});
+			});
 		});
 	});
 